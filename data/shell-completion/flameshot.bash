@@ -10,10 +10,12 @@ _flameshot() {
 
 	prev="${COMP_WORDS[COMP_CWORD-1]}"
 	cur="${COMP_WORDS[COMP_CWORD]}"
-	cmd="gui full config launcher screen"
+	cmd="gui full config launcher screen stream reconstruct"
 	screen_opts="--number --path --delay --raw --last-region -p -d -r -n"
 	gui_opts="--path --delay --raw --last-region -p -d -r"
-	full_opts="--path --delay --clipboard --raw --last-region -p -d -c -r"
+	full_opts="--path --delay --clipboard --raw --last-region --burst --interval --delta --scroll -p -d -c -r"
+	stream_opts="--region --fps --format --frames --drop-frames"
+	reconstruct_opts="--manifest --path -p"
 	config_opts="--contrastcolor --filename --maincolor --showhelp --trayicon --autostart -k -f -m -s -t -a"
 
 	case "${prev}" in
@@ -32,6 +34,22 @@ _flameshot() {
 			COMPREPLY=( $(compgen -W "$full_opts --help -h" -- "${cur}") )
 			return 0
 			;;
+		stream)
+			COMPREPLY=( $(compgen -W "$stream_opts --help -h" -- "${cur}") )
+			return 0
+			;;
+		reconstruct)
+			COMPREPLY=( $(compgen -W "$reconstruct_opts --help -h" -- "${cur}") )
+			return 0
+			;;
+		--manifest)
+			_filedir json
+			return 0
+			;;
+		--format)
+			COMPREPLY=( $(compgen -W "y4m rgba" -- "${cur}") )
+			return 0
+			;;
 		config)
 			COMPREPLY=( $(compgen -W "$config_opts --help -h" -- "${cur}") )
 			return 0
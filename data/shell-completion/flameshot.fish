@@ -1,4 +1,4 @@
-set -l SUBCOMMANDS gui screen full launcher config
+set -l SUBCOMMANDS gui screen full stream reconstruct launcher config
 
 ####################
 # HELPER FUNCTIONS #
@@ -106,6 +106,23 @@ __flameshot_complete full   -l "region"                 -frk -d "Screenshot regi
 __flameshot_complete full   -l "last-region"            -f   -d "Repeat screenshot with previously selected region"
 __flameshot_complete full   -l "raw"            -s "r"  -f   -d "Print raw PNG capture"
 __flameshot_complete full   -l "upload"         -s "u"  -f   -d "Upload the screenshot"
+__flameshot_complete full   -l "burst"                  -frk -d "Number of captures to take"
+__flameshot_complete full   -l "interval"               -frk -d "Time between the captures of a burst (200ms, 2s)"
+__flameshot_complete full   -l "delta"                  -f   -d "Only save the parts of a burst capture that changed"
+__flameshot_complete full   -l "scroll"                 -f   -d "Capture the region while it is scrolled and stitch it"
+
+# STREAM command
+__flameshot_complete stream                             -f
+__flameshot_complete stream -l "region"                 -frk -d "Screenshot region to select (WxH+X+Y)" -a "(__flameshot_complete_region stream)"
+__flameshot_complete stream -l "fps"                    -frk -d "Frames per second to capture"
+__flameshot_complete stream -l "format"                 -frk -d "Frame format" -a "y4m rgba"
+__flameshot_complete stream -l "frames"                 -frk -d "Stop after the given number of frames"
+__flameshot_complete stream -l "drop-frames"            -f   -d "Drop frames when the reader is slower than the capture"
+
+# RECONSTRUCT command
+__flameshot_complete reconstruct                        -f
+__flameshot_complete reconstruct -l "manifest"          -rk  -d "The .json file saved next to a --delta burst"
+__flameshot_complete reconstruct -l "path"      -s "p"  -rk  -d "Directory to write the frames to"
 
 # LAUNCHER command doesn't have any completions specific to itself
 
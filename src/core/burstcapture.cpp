@@ -0,0 +1,374 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "burstcapture.h"
+#include "abstractlogger.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/filenamehandler.h"
+#include "src/utils/screengrabber.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+
+// Frames held in memory while waiting for a worker, per worker
+#define PENDING_FRAMES_PER_WORKER 2
+
+BurstCapture::BurstCapture(const CaptureRequest& req, QObject* parent)
+  : QObject(parent)
+  , m_req(req)
+  , m_quality(-1)
+  , m_frames(static_cast<int>(req.burstCount()))
+  , m_delta(req.burstDelta())
+{
+    ConfigHandler config;
+    QString path = req.path().isEmpty() ? config.savePath() : req.path();
+    // A directory gets a name from the configured pattern, like a single
+    // capture would. The frames are numbered after it.
+    QFileInfo first(FileNameHandler().properScreenshotPath(
+      path, config.saveAsFileExtension()));
+    m_basePath = first.dir().absoluteFilePath(first.completeBaseName());
+    m_suffix = first.suffix();
+    if (m_suffix.compare("jpg", Qt::CaseInsensitive) == 0 ||
+        m_suffix.compare("jpeg", Qt::CaseInsensitive) == 0) {
+        m_quality = config.jpegQuality();
+    }
+
+    // Leave a core for the grabs
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    m_maxPending = m_pool.maxThreadCount() * PENDING_FRAMES_PER_WORKER;
+
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &BurstCapture::grabNext);
+}
+
+BurstCapture::~BurstCapture()
+{
+    m_pool.waitForDone();
+}
+
+void BurstCapture::start()
+{
+    AbstractLogger::info(AbstractLogger::Stderr)
+      << tr("Taking %1 captures every %2 ms into %3")
+           .arg(m_frames.size())
+           .arg(m_req.burstInterval())
+           .arg(QFileInfo(m_basePath).absolutePath());
+    m_clock.start();
+    grabNext();
+}
+
+void BurstCapture::grabNext()
+{
+    int index = m_grabbed;
+    Frame& frame = m_frames[index];
+    frame.path = QStringLiteral("%1-%2.%3")
+                   .arg(m_basePath)
+                   .arg(index + 1, 4, 10, QChar('0'))
+                   .arg(m_suffix);
+    frame.timestamp = QDateTime::currentDateTime();
+    frame.offset = m_clock.nsecsElapsed();
+    ScreenGrabber().grabEntireDesktop().then(
+      this, [this, index](const QPixmap& capture) {
+          onGrabbed(index, capture);
+      });
+}
+
+void BurstCapture::onGrabbed(int index, const QPixmap& capture)
+{
+    Frame& frame = m_frames[index];
+    frame.grabTime = m_clock.nsecsElapsed() - frame.offset;
+    ++m_grabbed;
+
+    if (capture.isNull()) {
+        frame.status = FAILED;
+    } else if (m_pending >= m_maxPending) {
+        // Waiting for a worker would delay the following grabs
+        frame.status = DROPPED;
+        AbstractLogger::warning(AbstractLogger::Stderr)
+          << tr("Dropped capture %1, the previous ones are still being saved")
+               .arg(index + 1);
+    } else {
+        QPixmap p = capture;
+        QRect region = m_req.initialSelection();
+        if (!region.isNull()) {
+            p = p.copy(region);
+        }
+        m_lastFrame = p;
+        // Pixmaps can't leave the GUI thread, the image shares their pixels
+        QImage image = p.toImage();
+        QImage previous;
+        if (m_delta) {
+            if (image.depth() != 32) {
+                image.convertTo(QImage::Format_RGB32);
+            }
+            previous = m_previous;
+            frame.reference = m_previousIndex;
+            m_previous = image;
+            m_previousIndex = index;
+        }
+        QString path = frame.path;
+        int quality = m_quality;
+        TileDelta delta = m_tileDelta;
+        ++m_pending;
+        m_pool.start([=, this]() {
+            bool keyframe = true;
+            QVector<QPoint> tiles;
+            QImage output = image;
+            if (!previous.isNull()) {
+                tiles = delta.changedTiles(previous, image);
+                // Past half of the tiles the whole frame is about as small
+                // and quicker to rebuild from
+                keyframe = tiles.size() * 2 > delta.tileCount(image.size());
+                output = keyframe ? image : delta.pack(image, tiles);
+            }
+            if (keyframe) {
+                tiles.clear();
+            }
+            bool ok = true;
+            QString error;
+            // Nothing changed, the manifest is enough
+            if (!output.isNull()) {
+                QImageWriter writer(path);
+                writer.setQuality(quality);
+                ok = writer.write(output);
+                error = ok ? QString() : writer.errorString();
+            }
+            QMetaObject::invokeMethod(
+              this,
+              [=, this]() { onSaved(index, ok, error, keyframe, tiles); },
+              Qt::QueuedConnection);
+        });
+    }
+
+    if (m_grabbed < m_frames.size()) {
+        qint64 due = static_cast<qint64>(m_grabbed) * m_req.burstInterval();
+        qint64 elapsed = m_clock.elapsed();
+        m_timer.start(static_cast<int>(qMax<qint64>(0, due - elapsed)));
+    } else {
+        finishIfDone();
+    }
+}
+
+void BurstCapture::onSaved(int index,
+                           bool ok,
+                           const QString& error,
+                           bool keyframe,
+                           const QVector<QPoint>& tiles)
+{
+    Frame& frame = m_frames[index];
+    --m_pending;
+    frame.status = ok ? SAVED : FAILED;
+    frame.keyframe = keyframe;
+    frame.tiles = tiles;
+    if (!ok) {
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << tr("Error trying to save as ") + frame.path + ": " + error;
+    }
+    finishIfDone();
+}
+
+void BurstCapture::finishIfDone()
+{
+    if (m_grabbed < m_frames.size() || m_pending > 0) {
+        return;
+    }
+
+    int saved = 0;
+    for (const Frame& frame : m_frames) {
+        saved += frame.status == SAVED ? 1 : 0;
+    }
+    bool timestampsOk = writeTimestamps();
+    if (m_delta) {
+        timestampsOk = writeManifest() && timestampsOk;
+    }
+    if (saved == 0 || !timestampsOk) {
+        emit failed();
+        return;
+    }
+    AbstractLogger::info().attachNotificationPath(m_frames.first().path)
+      << tr("Saved %1 of %2 captures in %3 ms")
+           .arg(saved)
+           .arg(m_frames.size())
+           .arg(m_clock.elapsed());
+    emit finished(m_lastFrame);
+}
+
+bool BurstCapture::writeTimestamps()
+{
+    QFile file(m_basePath + ".csv");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << tr("Error trying to save as ") + file.fileName() + ": " +
+               file.errorString();
+        return false;
+    }
+    QTextStream out(&file);
+    out << "frame,file,timestamp,offset_ms,grab_ms,status\n";
+    for (int i = 0; i < m_frames.size(); ++i) {
+        const Frame& frame = m_frames.at(i);
+        QString status;
+        switch (frame.status) {
+            case SAVED:
+                status = QStringLiteral("saved");
+                break;
+            case DROPPED:
+                status = QStringLiteral("dropped");
+                break;
+            default:
+                status = QStringLiteral("failed");
+                break;
+        }
+        bool written =
+          frame.status == SAVED && (frame.keyframe || !frame.tiles.isEmpty());
+        out << i + 1 << ','
+            << (written ? QFileInfo(frame.path).fileName() : QString())
+            << ',' << frame.timestamp.toString(Qt::ISODateWithMs) << ','
+            << QString::number(frame.offset / 1e6, 'f', 3) << ','
+            << QString::number(frame.grabTime / 1e6, 'f', 3) << ',' << status
+            << '\n';
+    }
+    return true;
+}
+
+bool BurstCapture::writeManifest()
+{
+    QJsonArray frames;
+    // A delta can only be applied when the frame it was taken against was
+    // saved and can be rebuilt itself. Frames that were never grabbed or were
+    // dropped are no reference to anything.
+    QVector<bool> usable(m_frames.size(), false);
+    for (int i = 0; i < m_frames.size(); ++i) {
+        const Frame& frame = m_frames.at(i);
+        QJsonObject entry = { { "frame", i + 1 } };
+        usable[i] = frame.status == SAVED &&
+                    (frame.keyframe ||
+                     (frame.reference >= 0 && usable.at(frame.reference)));
+        if (!usable.at(i)) {
+            entry["dropped"] = true;
+        } else if (frame.keyframe) {
+            entry["file"] = QFileInfo(frame.path).fileName();
+            entry["keyframe"] = true;
+        } else {
+            QJsonArray tiles;
+            for (const QPoint& tile : frame.tiles) {
+                tiles << tile.x() << tile.y();
+            }
+            if (!frame.tiles.isEmpty()) {
+                entry["file"] = QFileInfo(frame.path).fileName();
+            }
+            entry["tiles"] = tiles;
+        }
+        frames << entry;
+    }
+    QJsonObject manifest = { { "version", 1 },
+                             { "tileSize", m_tileDelta.tileSize() },
+                             { "atlasColumns", m_tileDelta.atlasColumns() },
+                             { "frames", frames } };
+
+    QFile file(m_basePath + ".json");
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(QJsonDocument(manifest).toJson(QJsonDocument::Compact)) <
+          0) {
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << tr("Error trying to save as ") + file.fileName() + ": " +
+               file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Rebuild every frame of a delta burst from its manifest.
+ *
+ * The frames are written as PNG files, named like the captures, into
+ * `outputPath`, which must not be the directory of the burst.
+ */
+bool BurstCapture::reconstruct(const QString& manifestPath,
+                               const QString& outputPath)
+{
+    AbstractLogger err = AbstractLogger::error(AbstractLogger::Stderr);
+    QFile file(manifestPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << tr("Unable to read %1: %2")
+                 .arg(manifestPath, file.errorString());
+        return false;
+    }
+    QJsonParseError parseError;
+    QJsonObject manifest =
+      QJsonDocument::fromJson(file.readAll(), &parseError).object();
+    if (parseError.error != QJsonParseError::NoError ||
+        manifest["version"].toInt() != 1) {
+        err << tr("%1 is not a burst manifest").arg(manifestPath);
+        return false;
+    }
+
+    QDir inputDir = QFileInfo(manifestPath).absoluteDir();
+    QDir outputDir(outputPath);
+    if (!QDir().mkpath(outputDir.absolutePath()) ||
+        outputDir.absolutePath() == inputDir.absolutePath()) {
+        err << tr("Invalid path, the frames can't be written to %1")
+                 .arg(outputPath);
+        return false;
+    }
+
+    TileDelta delta(manifest["tileSize"].toInt(),
+                    manifest["atlasColumns"].toInt());
+    QString baseName = QFileInfo(manifestPath).completeBaseName();
+    QImage frame;
+    int written = 0;
+    for (const QJsonValue& value : manifest["frames"].toArray()) {
+        QJsonObject entry = value.toObject();
+        int index = entry["frame"].toInt();
+        if (entry["dropped"].toBool()) {
+            continue;
+        }
+
+        QString source = entry["file"].toString();
+        QImage image;
+        if (!source.isEmpty()) {
+            QImageReader reader(inputDir.filePath(source));
+            if (!reader.read(&image)) {
+                err << tr("Unable to read %1: %2")
+                         .arg(reader.fileName(), reader.errorString());
+                return false;
+            }
+        }
+        if (entry["keyframe"].toBool()) {
+            frame = image;
+        } else {
+            QVector<QPoint> tiles;
+            QJsonArray coordinates = entry["tiles"].toArray();
+            for (int i = 0; i + 1 < coordinates.size(); i += 2) {
+                tiles << QPoint(coordinates[i].toInt(),
+                                coordinates[i + 1].toInt());
+            }
+            if (frame.isNull() ||
+                (!tiles.isEmpty() && !delta.apply(frame, image, tiles))) {
+                err << tr("Unable to rebuild frame %1").arg(index);
+                return false;
+            }
+        }
+
+        QString target =
+          outputDir.filePath(QStringLiteral("%1-%2.png")
+                               .arg(baseName)
+                               .arg(index, 4, 10, QChar('0')));
+        if (!frame.save(target)) {
+            err << tr("Error trying to save as ") + target;
+            return false;
+        }
+        ++written;
+    }
+
+    AbstractLogger::info(AbstractLogger::Stderr)
+      << tr("Rebuilt %1 frames in %2").arg(written).arg(outputDir.path());
+    return true;
+}
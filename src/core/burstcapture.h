@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/core/capturerequest.h"
+#include "src/utils/tiledelta.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPixmap>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * @brief Takes the captures of a `--burst` request in one process.
+ *
+ * Frame N is grabbed N intervals after the first one, measured from a
+ * monotonic clock so that late grabs do not shift the following ones. The
+ * frames are encoded and written by a small pool of workers. When more frames
+ * are waiting to be written than the pool can hold, new ones are dropped
+ * instead of delaying the next grab. Every frame gets a line in a CSV file
+ * next to the images with its timestamp, its offset from the first grab and
+ * how long the grab took.
+ *
+ * In delta mode only the first frame is saved whole. The following ones only
+ * keep the tiles that changed since the previous saved frame, see TileDelta,
+ * and a JSON manifest lists them so reconstruct() can rebuild every frame.
+ */
+class BurstCapture : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BurstCapture(const CaptureRequest& req, QObject* parent = nullptr);
+    ~BurstCapture();
+
+    void start();
+
+    static bool reconstruct(const QString& manifestPath,
+                            const QString& outputPath);
+
+signals:
+    void finished(const QPixmap& lastFrame);
+    void failed();
+
+private:
+    enum FrameStatus
+    {
+        PENDING,
+        SAVED,
+        DROPPED,
+        FAILED,
+    };
+
+    struct Frame
+    {
+        QString path;
+        QDateTime timestamp;
+        qint64 offset{ 0 };
+        qint64 grabTime{ 0 };
+        FrameStatus status{ PENDING };
+        bool keyframe{ true };
+        // Frame the tiles apply to, -1 for none
+        int reference{ -1 };
+        QVector<QPoint> tiles;
+    };
+
+    void grabNext();
+    void onGrabbed(int index, const QPixmap& capture);
+    void onSaved(int index,
+                 bool ok,
+                 const QString& error,
+                 bool keyframe,
+                 const QVector<QPoint>& tiles);
+    void finishIfDone();
+    bool writeTimestamps();
+    bool writeManifest();
+
+    CaptureRequest m_req;
+    QString m_basePath;
+    QString m_suffix;
+    int m_quality;
+    QVector<Frame> m_frames;
+    int m_grabbed{ 0 };
+    int m_pending{ 0 };
+    int m_maxPending;
+    QPixmap m_lastFrame;
+    bool m_delta;
+    TileDelta m_tileDelta;
+    QImage m_previous;
+    int m_previousIndex{ -1 };
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+    QThreadPool m_pool;
+};
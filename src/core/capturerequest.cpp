@@ -57,6 +57,26 @@ QRect CaptureRequest::initialSelection() const
     return m_initialSelection;
 }
 
+uint CaptureRequest::burstCount() const
+{
+    return m_burstCount;
+}
+
+uint CaptureRequest::burstInterval() const
+{
+    return m_burstInterval;
+}
+
+bool CaptureRequest::burstDelta() const
+{
+    return m_burstDelta;
+}
+
+bool CaptureRequest::scrolling() const
+{
+    return m_scrolling;
+}
+
 void CaptureRequest::addTask(CaptureRequest::ExportTask task)
 {
     if (task == SAVE) {
@@ -86,3 +106,24 @@ void CaptureRequest::setInitialSelection(const QRect& selection)
 {
     m_initialSelection = selection;
 }
+
+/**
+ * @brief Take `count` captures, one every `interval` milliseconds.
+ * @note The captures are only saved, see BurstCapture. With `delta` only the
+ * tiles that changed since the previous capture are.
+ */
+void CaptureRequest::setBurst(uint count, uint interval, bool delta)
+{
+    m_burstCount = qMax(1u, count);
+    m_burstInterval = interval;
+    m_burstDelta = delta;
+}
+
+/**
+ * @brief Grab the selection while it is scrolled and stitch the captures.
+ * @note See ScrollCapture.
+ */
+void CaptureRequest::setScrolling(bool scrolling)
+{
+    m_scrolling = scrolling;
+}
@@ -43,12 +43,18 @@ public:
     CaptureMode captureMode() const;
     ExportTask tasks() const;
     QRect initialSelection() const;
+    uint burstCount() const;
+    uint burstInterval() const;
+    bool burstDelta() const;
+    bool scrolling() const;
 
     void addTask(ExportTask task);
     void removeTask(ExportTask task);
     void addSaveTask(const QString& path = QString());
     void addPinTask(const QRect& pinWindowGeometry);
     void setInitialSelection(const QRect& selection);
+    void setBurst(uint count, uint interval, bool delta = false);
+    void setScrolling(bool scrolling);
 
 private:
     CaptureMode m_mode;
@@ -57,6 +63,10 @@ private:
     ExportTask m_tasks;
     QVariant m_data;
     QRect m_pinWindowGeometry, m_initialSelection;
+    uint m_burstCount{ 1 };
+    uint m_burstInterval{ 0 };
+    bool m_burstDelta{ false };
+    bool m_scrolling{ false };
 
     CaptureRequest() {}
 };
@@ -8,7 +8,9 @@
 #endif
 
 #include "abstractlogger.h"
+#include "burstcapture.h"
 #include "screenshotsaver.h"
+#include "scrollcapture.h"
 #include "src/config/configresolver.h"
 #include "src/config/configwindow.h"
 #include "src/core/qguiappcurrentscreen.h"
@@ -31,6 +33,7 @@
 #include <QDesktopServices>
 #include <QFile>
 #include <QMessageBox>
+#include <QPromise>
 #include <QThread>
 #include <QTimer>
 #include <QUrl>
@@ -40,6 +43,20 @@
 #include <QScreen>
 #endif
 
+namespace {
+
+QFuture<CaptureWidget*> withoutCaptureWidget()
+{
+    QPromise<CaptureWidget*> promise;
+    QFuture<CaptureWidget*> future = promise.future();
+    promise.start();
+    promise.addResult(nullptr);
+    promise.finish();
+    return future;
+}
+
+} // unnamed namespace
+
 Flameshot::Flameshot()
   : m_haveExternalWidget(false)
   , m_captureWindow(nullptr)
@@ -82,10 +99,10 @@ Flameshot* Flameshot::instance()
     return &c;
 }
 
-CaptureWidget* Flameshot::gui(const CaptureRequest& req)
+QFuture<CaptureWidget*> Flameshot::gui(const CaptureRequest& req)
 {
     if (!resolveAnyConfigErrors()) {
-        return nullptr;
+        return withoutCaptureWidget();
     }
 
 #if defined(Q_OS_MACOS)
@@ -117,26 +134,35 @@ CaptureWidget* Flameshot::gui(const CaptureRequest& req)
         if (0 == timeout) {
             QMessageBox::warning(
               nullptr, tr("Error"), tr("Unable to close active modal widgets"));
-            return nullptr;
+            return withoutCaptureWidget();
         }
 
-        m_captureWindow = new CaptureWidget(req);
+        return ScreenGrabber().grabEntireDesktop().then(
+          this, [this, req](const QPixmap& screenshot) -> CaptureWidget* {
+              // Another request may have opened its widget in the meantime
+              if (screenshot.isNull() || m_captureWindow != nullptr) {
+                  emit captureFailed();
+                  return nullptr;
+              }
+              m_captureWindow = new CaptureWidget(req, screenshot);
 
 #ifdef Q_OS_WIN
-        m_captureWindow->show();
+              m_captureWindow->show();
 #elif defined(Q_OS_MACOS)
-        // In "Emulate fullscreen mode"
-        m_captureWindow->showFullScreen();
-        m_captureWindow->activateWindow();
-        m_captureWindow->raise();
+              // In "Emulate fullscreen mode"
+              m_captureWindow->showFullScreen();
+              m_captureWindow->activateWindow();
+              m_captureWindow->raise();
 #else
-        m_captureWindow->showFullScreen();
-//        m_captureWindow->show(); // For CaptureWidget Debugging under Linux
+              m_captureWindow->showFullScreen();
+              // For CaptureWidget Debugging under Linux
+              // m_captureWindow->show();
 #endif
-        return m_captureWindow;
+              return m_captureWindow;
+          });
     } else {
         emit captureFailed();
-        return nullptr;
+        return withoutCaptureWidget();
     }
 }
 
@@ -146,7 +172,6 @@ void Flameshot::screen(CaptureRequest req, const int screenNumber)
         return;
     }
 
-    bool ok = true;
     QScreen* screen;
 
     if (screenNumber < 0) {
@@ -160,26 +185,30 @@ void Flameshot::screen(CaptureRequest req, const int screenNumber)
     } else {
         screen = qApp->screens()[screenNumber];
     }
-    QPixmap p(ScreenGrabber().grabScreen(screen, ok));
-    if (ok) {
-        QRect geometry = ScreenGrabber().screenGeometry(screen);
-        QRect region = req.initialSelection();
-        if (region.isNull()) {
-            region = ScreenGrabber().screenGeometry(screen);
-        } else {
-            QRect screenGeom = ScreenGrabber().screenGeometry(screen);
-            screenGeom.moveTopLeft({ 0, 0 });
-            region = region.intersected(screenGeom);
-            p = p.copy(region);
-        }
-        if (req.tasks() & CaptureRequest::PIN) {
-            // change geometry for pin task
-            req.addPinTask(region);
-        }
-        exportCapture(p, geometry, req);
-    } else {
-        emit captureFailed();
-    }
+    QPointer<QScreen> grabbedScreen(screen);
+    ScreenGrabber().grabScreen(screen).then(
+      this, [this, req, grabbedScreen](QPixmap p) mutable {
+          if (p.isNull() || grabbedScreen.isNull()) {
+              emit captureFailed();
+              return;
+          }
+          QScreen* screen = grabbedScreen;
+          QRect geometry = ScreenGrabber().screenGeometry(screen);
+          QRect region = req.initialSelection();
+          if (region.isNull()) {
+              region = ScreenGrabber().screenGeometry(screen);
+          } else {
+              QRect screenGeom = ScreenGrabber().screenGeometry(screen);
+              screenGeom.moveTopLeft({ 0, 0 });
+              region = region.intersected(screenGeom);
+              p = p.copy(region);
+          }
+          if (req.tasks() & CaptureRequest::PIN) {
+              // change geometry for pin task
+              req.addPinTask(region);
+          }
+          exportCapture(p, geometry, req);
+      });
 }
 
 void Flameshot::full(const CaptureRequest& req)
@@ -188,18 +217,60 @@ void Flameshot::full(const CaptureRequest& req)
         return;
     }
 
-    bool ok = true;
-    QPixmap p(ScreenGrabber().grabEntireDesktop(ok));
-    QRect region = req.initialSelection();
-    if (!region.isNull()) {
-        p = p.copy(region);
-    }
-    if (ok) {
+    ScreenGrabber().grabEntireDesktop().then(this, [this, req](QPixmap p) {
+        if (p.isNull()) {
+            emit captureFailed();
+            return;
+        }
+        QRect region = req.initialSelection();
+        if (!region.isNull()) {
+            p = p.copy(region);
+        }
         QRect selection; // `flameshot full` does not support --selection
         exportCapture(p, selection, req);
-    } else {
+    });
+}
+
+void Flameshot::burst(const CaptureRequest& req)
+{
+    if (!resolveAnyConfigErrors()) {
+        return;
+    }
+
+    auto* capture = new BurstCapture(req, this);
+    connect(capture,
+            &BurstCapture::finished,
+            this,
+            [this, capture](const QPixmap& lastFrame) {
+                capture->deleteLater();
+                emit captureTaken(lastFrame);
+            });
+    connect(capture, &BurstCapture::failed, this, [this, capture]() {
+        capture->deleteLater();
         emit captureFailed();
+    });
+    capture->start();
+}
+
+void Flameshot::scroll(const CaptureRequest& req)
+{
+    if (!resolveAnyConfigErrors()) {
+        return;
     }
+
+    auto* capture = new ScrollCapture(req, this);
+    connect(capture,
+            &ScrollCapture::finished,
+            this,
+            [this, capture, req](const QPixmap& p) {
+                capture->deleteLater();
+                exportCapture(p, QRect(), req);
+            });
+    connect(capture, &ScrollCapture::failed, this, [this, capture]() {
+        capture->deleteLater();
+        emit captureFailed();
+    });
+    capture->start();
 }
 
 void Flameshot::launcher()
@@ -343,8 +414,15 @@ void Flameshot::requestCapture(const CaptureRequest& request)
 
     switch (request.captureMode()) {
         case CaptureRequest::FULLSCREEN_MODE:
-            QTimer::singleShot(request.delay(),
-                               [this, request] { full(request); });
+            QTimer::singleShot(request.delay(), [this, request] {
+                if (request.scrolling()) {
+                    scroll(request);
+                } else if (request.burstCount() > 1) {
+                    burst(request);
+                } else {
+                    full(request);
+                }
+            });
             break;
         case CaptureRequest::SCREEN_MODE: {
             int&& number = request.data().toInt();
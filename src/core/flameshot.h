@@ -4,6 +4,7 @@
 #pragma once
 
 #include "src/core/capturerequest.h"
+#include <QFuture>
 #include <QObject>
 #include <QPointer>
 #include <QVersionNumber>
@@ -33,10 +34,14 @@ public:
     static Flameshot* instance();
 
 public slots:
-    CaptureWidget* gui(
+    // Finishes with the widget once the screen has been grabbed, or with
+    // nullptr when the capture failed
+    QFuture<CaptureWidget*> gui(
       const CaptureRequest& req = CaptureRequest::GRAPHICAL_MODE);
     void screen(CaptureRequest req, int const screenNumber = -1);
     void full(const CaptureRequest& req);
+    void burst(const CaptureRequest& req);
+    void scroll(const CaptureRequest& req);
     void launcher();
     void config();
 
@@ -26,6 +26,14 @@
 #include <QUrl>
 #endif
 
+#ifdef ENABLE_IMGUR
+#include "src/tools/imgupload/uploadqueue.h"
+#endif
+
+#if !defined(Q_OS_WIN)
+#include "src/utils/desktopentryindex.h"
+#endif
+
 #ifdef Q_OS_WIN
 #include "src/core/globalshortcutfilter.h"
 #endif
@@ -104,6 +112,13 @@ void FlameshotDaemon::start()
         // Tray icon needs FlameshotDaemon::instance() to be non-null
         m_instance->initTrayIcon();
         qApp->setQuitOnLastWindowClosed(false);
+#ifdef ENABLE_IMGUR
+        UploadQueue::instance()->resume();
+#endif
+#if !defined(Q_OS_WIN)
+        // The launcher opens without parsing the desktop entries
+        DesktopEntryIndex::instance()->keepWarm();
+#endif
     }
 }
 
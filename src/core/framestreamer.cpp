@@ -0,0 +1,357 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "framestreamer.h"
+#include "abstractlogger.h"
+#include "src/utils/screengrabber.h"
+#include <QFile>
+#include <QThread>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// Frames waiting for the writer, besides the one being written
+#define FRAME_QUEUE_SIZE 3
+
+namespace {
+
+inline uchar clampToByte(int value)
+{
+    return static_cast<uchar>(qBound(0, value, 255));
+}
+
+} // unnamed namespace
+
+FrameStreamer::FrameStreamer(const QRect& region,
+                             int fps,
+                             Format format,
+                             bool dropFrames,
+                             int frameLimit,
+                             QObject* parent)
+  : QObject(parent)
+  , m_region(region)
+  , m_fps(qMax(1, fps))
+  , m_format(format)
+  , m_dropFrames(dropFrames)
+  , m_frameLimit(frameLimit)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &FrameStreamer::tick);
+}
+
+FrameStreamer::~FrameStreamer()
+{
+    if (m_writer != nullptr) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_closing = true;
+            m_frameQueued.wakeAll();
+        }
+        m_writer->wait();
+        delete m_writer;
+    }
+}
+
+void FrameStreamer::start()
+{
+#if defined(Q_OS_UNIX)
+    // A reader that goes away ends the stream instead of the process
+    std::signal(SIGPIPE, SIG_IGN);
+#elif defined(Q_OS_WIN)
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    m_writer = QThread::create([this]() { writeFrames(); });
+    m_writer->start();
+    m_clock.start();
+    tick();
+}
+
+void FrameStreamer::tick()
+{
+    if (m_stopped || m_grabPending) {
+        return;
+    }
+    m_grabPending = true;
+    qint64 grabStart = m_clock.nsecsElapsed();
+    ScreenGrabber().grabDesktopRegion(m_region).then(
+      this, [this, grabStart](const QImage& capture) {
+          onGrabbed(capture, grabStart);
+      });
+}
+
+void FrameStreamer::onGrabbed(const QImage& capture, qint64 grabStart)
+{
+    m_grabPending = false;
+    if (m_stopped) {
+        return;
+    }
+    qint64 grabTime = m_clock.nsecsElapsed() - grabStart;
+    if (capture.isNull()) {
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << tr("Unable to capture screen");
+        stop(false);
+        return;
+    }
+
+    if (m_frameSize.isEmpty()) {
+        m_frameSize = capture.size();
+        AbstractLogger::info(AbstractLogger::Stderr)
+          << tr("Streaming %1x%2 %3 frames at %4 fps")
+               .arg(m_frameSize.width())
+               .arg(m_frameSize.height())
+               .arg(m_format == Y4M ? "y4m" : "rgba")
+               .arg(m_fps);
+        if (m_format == Y4M) {
+            // The samples use the full range, readers default to the limited
+            // one without XCOLORRANGE
+            enqueue(QStringLiteral("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C420jpeg "
+                                   "XCOLORRANGE=FULL\n")
+                      .arg(m_frameSize.width())
+                      .arg(m_frameSize.height())
+                      .arg(m_fps)
+                      .toLatin1());
+        }
+    } else if (capture.size() != m_frameSize) {
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << tr("The size of the captured region changed");
+        stop(false);
+        return;
+    }
+    m_grabTotal += grabTime;
+    m_grabMax = qMax(m_grabMax, grabTime);
+    ++m_statsFrames;
+
+    QByteArray buffer;
+    if (takeBuffer(buffer)) {
+        encode(capture, buffer);
+        enqueue(std::move(buffer));
+        ++m_frames;
+    } else {
+        QMutexLocker locker(&m_mutex);
+        if (m_outputClosed) {
+            locker.unlock();
+            stop(true);
+            return;
+        }
+        ++m_dropped;
+    }
+
+    if (m_frameLimit > 0 && m_frames >= m_frameLimit) {
+        stop(true);
+        return;
+    }
+    if (m_clock.elapsed() - m_statsStart >= 1000) {
+        logStats(false);
+    }
+
+    // Keep the rate when a frame is late, but don't try to catch up with it
+    m_nextFrame += 1000000000LL / m_fps;
+    qint64 now = m_clock.nsecsElapsed();
+    m_nextFrame = qMax(m_nextFrame, now);
+    m_timer.start(static_cast<int>((m_nextFrame - now) / 1000000));
+}
+
+/**
+ * @brief Get a buffer for the next frame.
+ *
+ * Waits for the writer when the queue is full, unless frames are dropped.
+ * @return false if the frame has to be dropped or the output was closed
+ */
+bool FrameStreamer::takeBuffer(QByteArray& buffer)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.size() >= FRAME_QUEUE_SIZE && !m_outputClosed) {
+        if (m_dropFrames) {
+            return false;
+        }
+        m_bufferFreed.wait(&m_mutex);
+    }
+    if (m_outputClosed) {
+        return false;
+    }
+    if (!m_freeBuffers.isEmpty()) {
+        buffer = m_freeBuffers.takeLast();
+    }
+    return true;
+}
+
+void FrameStreamer::enqueue(QByteArray&& buffer)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queue.enqueue(std::move(buffer));
+    m_frameQueued.wakeOne();
+}
+
+void FrameStreamer::encode(const QImage& capture, QByteArray& buffer) const
+{
+    QImage image = capture;
+    if (image.format() != QImage::Format_RGB32 &&
+        image.format() != QImage::Format_ARGB32 &&
+        image.format() != QImage::Format_ARGB32_Premultiplied) {
+        image = image.convertToFormat(QImage::Format_RGB32);
+    }
+    const int w = image.width();
+    const int h = image.height();
+
+    if (m_format == RGBA) {
+        // Straight alpha, and opaque whatever the grab left in the pad byte
+        if (image.format() == QImage::Format_ARGB32_Premultiplied) {
+            image.convertTo(QImage::Format_ARGB32);
+        }
+        const bool opaque = image.format() == QImage::Format_RGB32;
+        buffer.resize(static_cast<qsizetype>(w) * h * 4);
+        auto* out = reinterpret_cast<uchar*>(buffer.data());
+        for (int y = 0; y < h; ++y) {
+            auto* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+            for (int x = 0; x < w; ++x) {
+                *out++ = qRed(line[x]);
+                *out++ = qGreen(line[x]);
+                *out++ = qBlue(line[x]);
+                *out++ = opaque ? 0xff : qAlpha(line[x]);
+            }
+        }
+        return;
+    }
+
+    // Full range BT.601 like JPEG, with the chroma of every 2x2 block averaged
+    static const char frameHeader[] = "FRAME\n";
+    const qsizetype headerSize = sizeof(frameHeader) - 1;
+    const int chromaWidth = (w + 1) / 2;
+    const int chromaHeight = (h + 1) / 2;
+    const qsizetype lumaSize = static_cast<qsizetype>(w) * h;
+    const qsizetype chromaSize =
+      static_cast<qsizetype>(chromaWidth) * chromaHeight;
+    buffer.resize(headerSize + lumaSize + 2 * chromaSize);
+    std::memcpy(buffer.data(), frameHeader, headerSize);
+    auto* lumaPlane = reinterpret_cast<uchar*>(buffer.data()) + headerSize;
+    uchar* uPlane = lumaPlane + lumaSize;
+    uchar* vPlane = uPlane + chromaSize;
+
+    for (int y = 0; y < h; ++y) {
+        auto* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        uchar* luma = lumaPlane + static_cast<qsizetype>(y) * w;
+        for (int x = 0; x < w; ++x) {
+            QRgb p = line[x];
+            luma[x] = static_cast<uchar>(
+              (77 * qRed(p) + 150 * qGreen(p) + 29 * qBlue(p) + 128) >> 8);
+        }
+    }
+    for (int cy = 0; cy < chromaHeight; ++cy) {
+        auto* top = reinterpret_cast<const QRgb*>(image.constScanLine(2 * cy));
+        auto* bottom = reinterpret_cast<const QRgb*>(
+          image.constScanLine(qMin(2 * cy + 1, h - 1)));
+        uchar* u = uPlane + static_cast<qsizetype>(cy) * chromaWidth;
+        uchar* v = vPlane + static_cast<qsizetype>(cy) * chromaWidth;
+        for (int cx = 0; cx < chromaWidth; ++cx) {
+            int x0 = 2 * cx;
+            int x1 = qMin(x0 + 1, w - 1);
+            const QRgb block[4] = { top[x0], top[x1], bottom[x0], bottom[x1] };
+            int r = 0, g = 0, b = 0;
+            for (QRgb p : block) {
+                r += qRed(p);
+                g += qGreen(p);
+                b += qBlue(p);
+            }
+            // Sums of four pixels, so shift by two more bits
+            u[cx] = clampToByte(((-43 * r - 85 * g + 128 * b) >> 10) + 128);
+            v[cx] = clampToByte(((128 * r - 107 * g - 21 * b) >> 10) + 128);
+        }
+    }
+}
+
+void FrameStreamer::writeFrames()
+{
+    QFile out;
+    bool ok = out.open(fileno(stdout),
+                       QIODevice::WriteOnly | QIODevice::Unbuffered,
+                       QFileDevice::DontCloseHandle);
+    forever {
+        QByteArray buffer;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queue.isEmpty() && !m_closing) {
+                m_frameQueued.wait(&m_mutex);
+            }
+            if (m_queue.isEmpty()) {
+                return;
+            }
+            buffer = m_queue.dequeue();
+        }
+
+        qsizetype written = 0;
+        while (ok && written < buffer.size()) {
+            qint64 n = out.write(buffer.constData() + written,
+                                 buffer.size() - written);
+            ok = n > 0;
+            written += qMax<qint64>(n, 0);
+        }
+
+        QMutexLocker locker(&m_mutex);
+        m_freeBuffers.append(std::move(buffer));
+        if (!ok) {
+            m_outputClosed = true;
+            m_queue.clear();
+        }
+        m_bufferFreed.wakeAll();
+        if (!ok) {
+            return;
+        }
+    }
+}
+
+void FrameStreamer::logStats(bool summary)
+{
+    qint64 now = m_clock.elapsed();
+    if (summary) {
+        AbstractLogger::info(AbstractLogger::Stderr)
+          << tr("Stream ended after %1 s, %2 frames at %3 fps, %4 dropped")
+               .arg(now / 1000.0, 0, 'f', 1)
+               .arg(m_frames)
+               .arg(m_frames * 1000.0 / qMax<qint64>(1, now), 0, 'f', 1)
+               .arg(m_dropped);
+        return;
+    }
+
+    qint64 span = qMax<qint64>(1, now - m_statsStart);
+    double grabAverage =
+      m_statsFrames > 0 ? m_grabTotal / 1e6 / m_statsFrames : 0.0;
+    AbstractLogger::info(AbstractLogger::Stderr)
+      << tr("%1 fps, grab %2 ms average, %3 ms max, %4 frames, %5 dropped")
+           .arg(m_statsFrames * 1000.0 / span, 0, 'f', 1)
+           .arg(grabAverage, 0, 'f', 2)
+           .arg(m_grabMax / 1e6, 0, 'f', 2)
+           .arg(m_frames)
+           .arg(m_dropped);
+    m_statsStart = now;
+    m_statsFrames = 0;
+    m_grabTotal = 0;
+    m_grabMax = 0;
+}
+
+void FrameStreamer::stop(bool ok)
+{
+    if (m_stopped) {
+        return;
+    }
+    m_stopped = true;
+    m_timer.stop();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closing = true;
+        m_frameQueued.wakeAll();
+    }
+    // Lets the writer drain the queue
+    m_writer->wait();
+    if (m_outputClosed) {
+        AbstractLogger::info(AbstractLogger::Stderr)
+          << tr("The reader closed the stream");
+    }
+    logStats(true);
+    emit finished(ok);
+}
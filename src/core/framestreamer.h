@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QRect>
+#include <QTimer>
+#include <QWaitCondition>
+
+class QThread;
+
+/**
+ * @brief Writes a region of the desktop to stdout as raw video frames.
+ *
+ * Frames are grabbed at a fixed rate on the GUI thread and handed to a writer
+ * thread through a short queue of reused buffers. When the reader can't keep
+ * up, the grabs either wait for a free buffer, which slows the stream down, or
+ * the new frames are dropped. Once a second a stats line with the achieved
+ * frame rate and grab latency is logged on stderr.
+ *
+ * Y4M streams are 4:2:0 full range YUV, which the stream header declares
+ * with XCOLORRANGE=FULL. Readers that ignore it take the samples as limited
+ * range and shift the levels. RGBA streams are the bare pixels with straight
+ * alpha, opaque ones included, one frame after the other. They have no
+ * header, the frame size is only logged on stderr.
+ */
+class FrameStreamer : public QObject
+{
+    Q_OBJECT
+public:
+    enum Format
+    {
+        Y4M,
+        RGBA,
+    };
+
+    FrameStreamer(const QRect& region,
+                  int fps,
+                  Format format,
+                  bool dropFrames,
+                  int frameLimit = 0,
+                  QObject* parent = nullptr);
+    ~FrameStreamer();
+
+    void start();
+
+signals:
+    void finished(bool ok);
+
+private:
+    void tick();
+    void onGrabbed(const QImage& capture, qint64 grabStart);
+    bool takeBuffer(QByteArray& buffer);
+    void enqueue(QByteArray&& buffer);
+    void encode(const QImage& image, QByteArray& buffer) const;
+    void writeFrames();
+    void logStats(bool summary);
+    void stop(bool ok);
+
+    QRect m_region;
+    int m_fps;
+    Format m_format;
+    bool m_dropFrames;
+    int m_frameLimit;
+    QSize m_frameSize;
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_nextFrame{ 0 };
+    bool m_grabPending{ false };
+    bool m_stopped{ false };
+
+    qint64 m_frames{ 0 };
+    qint64 m_dropped{ 0 };
+    qint64 m_statsFrames{ 0 };
+    qint64 m_statsStart{ 0 };
+    qint64 m_grabTotal{ 0 };
+    qint64 m_grabMax{ 0 };
+
+    // Shared with the writer thread
+    QMutex m_mutex;
+    QWaitCondition m_frameQueued;
+    QWaitCondition m_bufferFreed;
+    QQueue<QByteArray> m_queue;
+    QList<QByteArray> m_freeBuffers;
+    bool m_closing{ false };
+    bool m_outputClosed{ false };
+    QThread* m_writer{ nullptr };
+};
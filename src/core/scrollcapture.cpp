@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "scrollcapture.h"
+#include "abstractlogger.h"
+#include "src/utils/screengrabber.h"
+
+// Time between two grabs, in milliseconds
+#define SCROLL_GRAB_INTERVAL 50
+// The capture ends after this many milliseconds without scrolling
+#define SCROLL_IDLE_TIMEOUT 2000
+// QPainter can't draw past this size
+#define MAX_SCROLL_HEIGHT 32767
+
+ScrollCapture::ScrollCapture(const CaptureRequest& req, QObject* parent)
+  : QObject(parent)
+  , m_req(req)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &ScrollCapture::grabNext);
+}
+
+void ScrollCapture::start()
+{
+    AbstractLogger::info(AbstractLogger::Stderr)
+      << tr("Scroll down the selected region, the capture ends after %1 s "
+            "without scrolling")
+           .arg(SCROLL_IDLE_TIMEOUT / 1000.0);
+    m_idle.start();
+    grabNext();
+}
+
+void ScrollCapture::grabNext()
+{
+    ScreenGrabber()
+      .grabDesktopRegion(m_req.initialSelection())
+      .then(this, [this](const QImage& capture) { onGrabbed(capture); });
+}
+
+void ScrollCapture::onGrabbed(const QImage& capture)
+{
+    if (capture.isNull()) {
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << tr("Unable to capture screen");
+        if (m_stitcher.isEmpty()) {
+            emit failed();
+        } else {
+            finish();
+        }
+        return;
+    }
+
+    ++m_frames;
+    // The X11 grabs reuse their buffer, the stitcher keeps the last frame
+    switch (m_stitcher.addFrame(capture.copy())) {
+        case ScrollStitcher::APPENDED:
+            m_idle.restart();
+            break;
+        case ScrollStitcher::NO_MATCH:
+            if (!m_lostTrack) {
+                m_lostTrack = true;
+                AbstractLogger::warning(AbstractLogger::Stderr)
+                  << tr("Lost track of the scrolled content, scroll back up "
+                        "a little and more slowly");
+            }
+            break;
+        case ScrollStitcher::INVALID_FRAME:
+            AbstractLogger::error(AbstractLogger::Stderr)
+              << tr("The size of the captured region changed");
+            finish();
+            return;
+        default:
+            break;
+    }
+
+    if (m_stitcher.height() >= MAX_SCROLL_HEIGHT) {
+        AbstractLogger::warning(AbstractLogger::Stderr)
+          << tr("The capture reached its maximum height");
+        finish();
+    } else if (m_idle.elapsed() >= SCROLL_IDLE_TIMEOUT) {
+        finish();
+    } else {
+        m_timer.start(SCROLL_GRAB_INTERVAL);
+    }
+}
+
+void ScrollCapture::finish()
+{
+    QImage image = m_stitcher.result();
+    if (image.height() > MAX_SCROLL_HEIGHT) {
+        image = image.copy(0, 0, image.width(), MAX_SCROLL_HEIGHT);
+    }
+    AbstractLogger::info(AbstractLogger::Stderr)
+      << tr("Stitched %1 captures into %2x%3")
+           .arg(m_frames)
+           .arg(image.width())
+           .arg(image.height());
+    emit finished(QPixmap::fromImage(std::move(image)));
+}
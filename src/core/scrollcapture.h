@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/core/capturerequest.h"
+#include "src/utils/scrollstitcher.h"
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPixmap>
+#include <QTimer>
+
+/**
+ * @brief Takes the capture of a `--scroll` request.
+ *
+ * The selected region is grabbed repeatedly while the user scrolls it and
+ * every frame is stitched to the previous ones, see ScrollStitcher. The
+ * capture ends once nothing scrolled for a while, or when the stitched image
+ * reaches the largest size that can still be painted.
+ */
+class ScrollCapture : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ScrollCapture(const CaptureRequest& req,
+                           QObject* parent = nullptr);
+
+    void start();
+
+signals:
+    void finished(const QPixmap& capture);
+    void failed();
+
+private:
+    void grabNext();
+    void onGrabbed(const QImage& capture);
+    void finish();
+
+    CaptureRequest m_req;
+    ScrollStitcher m_stitcher;
+    QTimer m_timer;
+    QElapsedTimer m_idle;
+    int m_frames{ 0 };
+    bool m_lostTrack{ false };
+};
@@ -13,9 +13,11 @@
 #include "src/cli/commandlineparser.h"
 #include "src/config/cacheutils.h"
 #include "src/config/styleoverride.h"
+#include "src/core/burstcapture.h"
 #include "src/core/capturerequest.h"
 #include "src/core/flameshot.h"
 #include "src/core/flameshotdaemon.h"
+#include "src/core/framestreamer.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/pathinfo.h"
@@ -26,6 +28,7 @@
 #include <QSharedMemory>
 #include <QTimer>
 #include <QTranslator>
+#include <limits>
 #if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
 #include "abstractlogger.h"
 #include "src/core/flameshotdbusadapter.h"
@@ -155,6 +158,25 @@ void configureApp(bool gui)
     app->setAttribute(Qt::AA_DontCreateNativeWidgetSiblings, true);
 }
 
+/// Milliseconds in "250", "250ms", "2s" or "1.5s", -1 if the value is invalid
+int parseInterval(const QString& value)
+{
+    QString number = value.trimmed();
+    double scale = 1;
+    if (number.endsWith(QLatin1String("ms"))) {
+        number.chop(2);
+    } else if (number.endsWith('s')) {
+        number.chop(1);
+        scale = 1000;
+    }
+    bool ok;
+    double interval = number.toDouble(&ok) * scale;
+    if (!ok || interval < 0 || interval > std::numeric_limits<int>::max()) {
+        return -1;
+    }
+    return qRound(interval);
+}
+
 // TODO find a way so we don't have to do this
 /// Recreate the application as a QApplication
 void reinitializeAsQApplication(int& argc, char* argv[])
@@ -230,6 +252,12 @@ int main(int argc, char* argv[])
     CommandArgument screenArgument(
       QStringLiteral("screen"),
       QObject::tr("Capture a screenshot of the specified monitor."));
+    CommandArgument streamArgument(
+      QStringLiteral("stream"),
+      QObject::tr("Write raw video frames of a region to stdout."));
+    CommandArgument reconstructArgument(
+      QStringLiteral("reconstruct"),
+      QObject::tr("Rebuild the frames of a burst taken with --delta."));
 
     // Options
     CommandOption pathOption(
@@ -253,6 +281,44 @@ int main(int argc, char* argv[])
     CommandOption regionOption("region",
                                QObject::tr("Screenshot region to select"),
                                QStringLiteral("WxH+X+Y or string"));
+    CommandOption burstOption(
+      "burst",
+      QObject::tr("Take the given number of captures and save each of them"),
+      QStringLiteral("count"));
+    CommandOption intervalOption(
+      "interval",
+      QObject::tr("Time between the captures of a burst, e.g. 200ms or 2s"),
+      QStringLiteral("duration"),
+      QStringLiteral("1s"));
+    CommandOption deltaOption(
+      "delta",
+      QObject::tr("Only save the parts of a burst capture that changed"));
+    CommandOption manifestOption(
+      "manifest",
+      QObject::tr("The .json file saved next to a --delta burst"),
+      QStringLiteral("file"));
+    CommandOption scrollOption(
+      "scroll",
+      QObject::tr("Capture the region while it is scrolled down and stitch "
+                  "it into one tall image"));
+    CommandOption fpsOption("fps",
+                            QObject::tr("Frames per second to capture"),
+                            QStringLiteral("rate"),
+                            QStringLiteral("30"));
+    CommandOption formatOption(
+      "format",
+      QObject::tr("Frame format, y4m or rgba (raw RGBA pixels without a "
+                  "header, the frame size is only logged on stderr)"),
+      QStringLiteral("format"),
+      QStringLiteral("y4m"));
+    CommandOption framesOption(
+      "frames",
+      QObject::tr("Stop after the given number of frames"),
+      QStringLiteral("count"));
+    CommandOption dropFramesOption(
+      "drop-frames",
+      QObject::tr("Drop frames when the reader is slower than the capture, "
+                  "instead of waiting for it"));
     CommandOption filenameOption({ "f", "filename" },
                                  QObject::tr("Set the filename pattern"),
                                  QStringLiteral("pattern"));
@@ -321,6 +387,30 @@ int main(int argc, char* argv[])
         int value = delayValue.toInt(&ok);
         return ok && value >= 0;
     };
+    const QString burstErr =
+      QObject::tr("Invalid burst, it must be a number greater than 0");
+    auto burstChecker = [](const QString& burstValue) -> bool {
+        bool ok;
+        int value = burstValue.toInt(&ok);
+        return ok && value > 0;
+    };
+    const QString intervalErr = QObject::tr(
+      "Invalid interval, use milliseconds or a duration like 200ms or 2s");
+    auto intervalChecker = [](const QString& intervalValue) -> bool {
+        return parseInterval(intervalValue) >= 0;
+    };
+    const QString fpsErr =
+      QObject::tr("Invalid frame rate, it must be between 1 and 1000");
+    auto fpsChecker = [](const QString& fpsValue) -> bool {
+        bool ok;
+        int value = fpsValue.toInt(&ok);
+        return ok && value > 0 && value <= 1000;
+    };
+    const QString formatErr =
+      QObject::tr("Invalid format, it must be 'y4m' or 'rgba'");
+    auto formatChecker = [](const QString& value) -> bool {
+        return value == QLatin1String("y4m") || value == QLatin1String("rgba");
+    };
     auto regionChecker = [](const QString& region) -> bool {
         Region valueHandler;
         return valueHandler.check(region);
@@ -350,6 +440,11 @@ int main(int argc, char* argv[])
     mainColorOption.addChecker(colorChecker, colorErr);
     delayOption.addChecker(numericChecker, delayErr);
     regionOption.addChecker(regionChecker, regionErr);
+    burstOption.addChecker(burstChecker, burstErr);
+    intervalOption.addChecker(intervalChecker, intervalErr);
+    fpsOption.addChecker(fpsChecker, fpsErr);
+    formatOption.addChecker(formatChecker, formatErr);
+    framesOption.addChecker(burstChecker, burstErr);
     useLastRegionOption.addChecker(booleanChecker, booleanErr);
     pathOption.addChecker(pathChecker, pathErr);
     trayOption.addChecker(booleanChecker, booleanErr);
@@ -362,6 +457,8 @@ int main(int argc, char* argv[])
     parser.AddArgument(guiArgument);
     parser.AddArgument(screenArgument);
     parser.AddArgument(fullArgument);
+    parser.AddArgument(streamArgument);
+    parser.AddArgument(reconstructArgument);
     parser.AddArgument(launcherArgument);
     parser.AddArgument(configArgument);
     auto helpOption = parser.addHelpOption();
@@ -391,8 +488,16 @@ int main(int argc, char* argv[])
                         delayOption,
                         regionOption,
                         rawImageOption,
-                        uploadOption },
+                        uploadOption,
+                        burstOption,
+                        intervalOption,
+                        deltaOption,
+                        scrollOption },
                       fullArgument);
+    parser.AddOptions(
+      { regionOption, fpsOption, formatOption, framesOption, dropFramesOption },
+      streamArgument);
+    parser.AddOptions({ manifestOption, pathOption }, reconstructArgument);
     parser.AddOptions({ autostartOption,
                         notificationOption,
                         filenameOption,
@@ -513,6 +618,29 @@ int main(int argc, char* argv[])
         if (!clipboard && path.isEmpty() && !raw && !upload) {
             req.addSaveTask();
         }
+        if (parser.isSet(scrollOption)) {
+            if (parser.isSet(burstOption)) {
+                AbstractLogger::error() << QObject::tr(
+                  "The --scroll and --burst options can't be used together");
+                return 1;
+            }
+            req.setScrolling(true);
+        }
+        if (parser.isSet(burstOption)) {
+            if (clipboard || raw || upload) {
+                AbstractLogger::error()
+                  << QObject::tr("The --burst option only saves the captures, "
+                                 "use it with --path");
+                return 1;
+            }
+            req.setBurst(parser.value(burstOption).toUInt(),
+                         parseInterval(parser.value(intervalOption)),
+                         parser.isSet(deltaOption));
+        } else if (parser.isSet(deltaOption)) {
+            AbstractLogger::error()
+              << QObject::tr("The --delta option requires --burst");
+            return 1;
+        }
         return requestCaptureAndWait(req);
     } else if (parser.isSet(screenArgument)) { // SCREEN
         reinitializeAsQApplication(argc, argv);
@@ -564,6 +692,35 @@ int main(int argc, char* argv[])
         }
 
         return requestCaptureAndWait(req);
+    } else if (parser.isSet(streamArgument)) { // STREAM
+        reinitializeAsQApplication(argc, argv);
+
+        QRect region;
+        if (parser.isSet(regionOption)) {
+            region = Region().value(parser.value(regionOption)).toRect();
+        }
+        FrameStreamer streamer(region,
+                               parser.value(fpsOption).toInt(),
+                               parser.value(formatOption) ==
+                                   QLatin1String("rgba")
+                                 ? FrameStreamer::RGBA
+                                 : FrameStreamer::Y4M,
+                               parser.isSet(dropFramesOption),
+                               parser.value(framesOption).toInt());
+        QObject::connect(&streamer, &FrameStreamer::finished, [](bool ok) {
+            qApp->exit(ok ? 0 : 1);
+        });
+        streamer.start();
+        return qApp->exec();
+    } else if (parser.isSet(reconstructArgument)) { // RECONSTRUCT
+        if (!parser.isSet(manifestOption) || !parser.isSet(pathOption)) {
+            AbstractLogger::error()
+              << QObject::tr("Both --manifest and --path are required");
+            return 1;
+        }
+        bool ok = BurstCapture::reconstruct(parser.value(manifestOption),
+                                            parser.value(pathOption));
+        return ok ? 0 : 1;
     } else if (parser.isSet(configArgument)) { // CONFIG
         bool autostart = parser.isSet(autostartOption);
         bool notification = parser.isSet(notificationOption);
@@ -5,6 +5,21 @@
 #include "capturerequest.h"
 #include "flameshot.h"
 
+const QImage& PixmapImageMirror::image(const QPixmap& pixmap) const
+{
+    if (pixmap.cacheKey() != m_cacheKey) {
+        m_image = pixmap.toImage();
+        m_cacheKey = pixmap.cacheKey();
+    }
+    return m_image;
+}
+
+void PixmapImageMirror::release() const
+{
+    m_image = QImage();
+    m_cacheKey = 0;
+}
+
 // TODO rename
 QPixmap CaptureContext::selectedScreenshotArea() const
 {
@@ -14,3 +29,13 @@ QPixmap CaptureContext::selectedScreenshotArea() const
         return screenshot.copy(selection);
     }
 }
+
+const QImage& CaptureContext::screenshotImage() const
+{
+    return m_screenshotMirror.image(screenshot);
+}
+
+void CaptureContext::releaseScreenshotImage() const
+{
+    m_screenshotMirror.release();
+}
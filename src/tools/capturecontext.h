@@ -4,11 +4,28 @@
 #pragma once
 
 #include "capturerequest.h"
+#include <QImage>
 #include <QPainter>
 #include <QPixmap>
 #include <QPoint>
 #include <QRect>
 
+// Read-only QImage view of a QPixmap for code that reads pixels. The pixmap
+// is converted on first use and then only again after it has been modified,
+// which is detected through QPixmap::cacheKey().
+class PixmapImageMirror
+{
+public:
+    const QImage& image(const QPixmap& pixmap) const;
+    // The image shares the pixels of the pixmap, which painting on the pixmap
+    // would then have to copy
+    void release() const;
+
+private:
+    mutable QImage m_image;
+    mutable qint64 m_cacheKey = 0;
+};
+
 struct CaptureContext
 {
     // screenshot with modifications
@@ -34,4 +51,12 @@ struct CaptureContext
     CaptureRequest request = CaptureRequest::GRAPHICAL_MODE;
 
     QPixmap selectedScreenshotArea() const;
+
+    // CPU side view of screenshot, always in sync with the current pixmap,
+    // to release once done reading it
+    const QImage& screenshotImage() const;
+    void releaseScreenshotImage() const;
+
+private:
+    PixmapImageMirror m_screenshotMirror;
 };
@@ -3,49 +3,41 @@
 //
 
 #include "imguploadermanager.h"
+#include "src/utils/confighandler.h"
 #include <QPixmap>
 #include <QWidget>
 
 // TODO - remove this hard-code and create plugin manager in the future, you may
 // include other storage headers here
+#include "storages/http/httpuploader.h"
 #include "storages/imgur/imguruploader.h"
 
 ImgUploaderManager::ImgUploaderManager(QObject* parent)
   : QObject(parent)
   , m_imgUploaderBase(nullptr)
 {
-    // TODO - implement ImgUploader for other Storages and selection among them
-    m_imgUploaderPlugin = IMG_UPLOADER_STORAGE_DEFAULT;
+    m_imgUploaderPlugin = ConfigHandler().uploadStorage();
     init();
 }
 
 void ImgUploaderManager::init()
 {
-    // TODO - implement ImgUploader for other Storages and selection among them,
-    // example:
-    // if (uploaderPlugin().compare("s3") == 0) {
-    //    m_qstrUrl = ImgS3Settings().value("S3", "S3_URL").toString();
-    //} else {
-    //    m_qstrUrl = "https://imgur.com/";
-    //    m_imgUploaderPlugin = "imgur";
-    //}
-    m_urlString = "https://imgur.com/";
-    m_imgUploaderPlugin = "imgur";
+    if (uploaderPlugin() == HTTP_UPLOADER_STORAGE) {
+        m_urlString = HttpUploader::link(QString());
+    } else {
+        m_urlString = "https://imgur.com/";
+        m_imgUploaderPlugin = IMG_UPLOADER_STORAGE_DEFAULT;
+    }
 }
 
 ImgUploaderBase* ImgUploaderManager::uploader(const QPixmap& capture,
                                               QWidget* parent)
 {
-    // TODO - implement ImgUploader for other Storages and selection among them,
-    // example:
-    // if (uploaderPlugin().compare("s3") == 0) {
-    //    m_imgUploaderBase =
-    //      (ImgUploaderBase*)(new ImgS3Uploader(capture, parent));
-    //} else {
-    //    m_imgUploaderBase =
-    //      (ImgUploaderBase*)(new ImgurUploader(capture, parent));
-    //}
-    m_imgUploaderBase = (ImgUploaderBase*)(new ImgurUploader(capture, parent));
+    if (uploaderPlugin() == HTTP_UPLOADER_STORAGE) {
+        m_imgUploaderBase = new HttpUploader(capture, parent);
+    } else {
+        m_imgUploaderBase = new ImgurUploader(capture, parent);
+    }
     if (m_imgUploaderBase && !capture.isNull()) {
         m_imgUploaderBase->upload();
     }
@@ -68,3 +60,41 @@ const QString& ImgUploaderManager::url()
 {
     return m_urlString;
 }
+
+// Link to an image uploaded to `storage`, as recorded in the history
+QString ImgUploaderManager::link(const QString& storage, const QString& name)
+{
+    if (storage == HTTP_UPLOADER_STORAGE) {
+        return HttpUploader::link(name);
+    }
+    return "https://imgur.com/" + name;
+}
+
+/**
+ * @brief Start sending `image`, encoded as `format`, to `storage`.
+ * @return The reply, or nullptr if the storage is unknown
+ */
+QNetworkReply* ImgUploaderManager::send(const QString& storage,
+                                        QNetworkAccessManager* networkAM,
+                                        QIODevice* image,
+                                        const QString& format)
+{
+    if (storage == HTTP_UPLOADER_STORAGE) {
+        return HttpUploader::send(networkAM, image, format);
+    }
+    if (storage == IMG_UPLOADER_STORAGE_DEFAULT) {
+        return ImgurUploader::send(networkAM, image);
+    }
+    return nullptr;
+}
+
+bool ImgUploaderManager::parseReply(const QString& storage,
+                                    QNetworkReply* reply,
+                                    UploadResult& result,
+                                    QString& error)
+{
+    if (storage == HTTP_UPLOADER_STORAGE) {
+        return HttpUploader::parseReply(reply, result, error);
+    }
+    return ImgurUploader::parseReply(reply, result, error);
+}
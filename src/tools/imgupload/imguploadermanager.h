@@ -6,10 +6,14 @@
 #define FLAMESHOT_IMGUPLOADERMANAGER_H
 
 #include "src/tools/imgupload/storages/imguploaderbase.h"
+#include "src/tools/imgupload/uploadqueue.h"
 #include <QObject>
 
 #define IMG_UPLOADER_STORAGE_DEFAULT "imgur"
 
+class QIODevice;
+class QNetworkAccessManager;
+class QNetworkReply;
 class QPixmap;
 class QWidget;
 
@@ -24,6 +28,15 @@ public:
     ImgUploaderBase* uploader(const QString& imgUploaderPlugin);
 
     const QString& url();
+    static QString link(const QString& storage, const QString& name);
+    static QNetworkReply* send(const QString& storage,
+                               QNetworkAccessManager* networkAM,
+                               QIODevice* image,
+                               const QString& format);
+    static bool parseReply(const QString& storage,
+                           QNetworkReply* reply,
+                           UploadResult& result,
+                           QString& error);
     const QString& uploaderPlugin();
 
 private:
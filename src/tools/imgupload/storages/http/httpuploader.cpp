@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "httpuploader.h"
+#include "abstractlogger.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/filenamehandler.h"
+#include <QHttpMultiPart>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+namespace {
+
+// The history packs the storage, the token and the name in a file name with
+// dashes between them, so the values it stores can't hold any
+QString historyValue(const QString& value)
+{
+    return QString::fromLatin1(QUrl::toPercentEncoding(value, {}, "-"));
+}
+
+QString fromHistoryValue(const QString& value)
+{
+    return QUrl::fromPercentEncoding(value.toLatin1());
+}
+
+// Substitutes `value` for `placeholder` in a URL template
+QString fillTemplate(QString urlTemplate,
+                     const QString& placeholder,
+                     const QString& value)
+{
+    return urlTemplate.replace(
+      placeholder,
+      QString::fromLatin1(
+        QUrl::toPercentEncoding(fromHistoryValue(value), "/")));
+}
+
+} // unnamed namespace
+
+HttpUploader::HttpUploader(const QPixmap& capture, QWidget* parent)
+  : ImgUploaderBase(capture, parent)
+{}
+
+QString HttpUploader::storage() const
+{
+    return QStringLiteral(HTTP_UPLOADER_STORAGE);
+}
+
+// Link to the image called `name` in the history
+QString HttpUploader::link(const QString& name)
+{
+    return fillTemplate(
+      ConfigHandler().uploadHttpLink(), QStringLiteral("{name}"), name);
+}
+
+QNetworkReply* HttpUploader::send(QNetworkAccessManager* networkAM,
+                                  QIODevice* image,
+                                  const QString& format)
+{
+    ConfigHandler config;
+    QHttpPart part;
+    part.setHeader(QNetworkRequest::ContentTypeHeader, "image/" + format);
+    part.setHeader(
+      QNetworkRequest::ContentDispositionHeader,
+      QStringLiteral("form-data; name=\"%1\"; filename=\"%2.%3\"")
+        .arg(config.uploadHttpField(),
+             FileNameHandler().parsedPattern(),
+             format == "jpeg" ? QStringLiteral("jpg") : format));
+    // Read from the file while it is sent, not copied to memory first
+    part.setBodyDevice(image);
+
+    auto* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    multiPart->append(part);
+
+    QNetworkRequest request(QUrl(config.uploadHttpUrl()));
+    authorize(request);
+    QNetworkReply* reply = networkAM->post(request, multiPart);
+    multiPart->setParent(reply);
+    return reply;
+}
+
+bool HttpUploader::parseReply(QNetworkReply* reply,
+                              UploadResult& result,
+                              QString& error)
+{
+    const QByteArray body = reply->readAll();
+    if (reply->error() != QNetworkReply::NoError) {
+        error =
+          reply->errorString() + "\n" + QString::fromUtf8(body.left(200));
+        return false;
+    }
+
+    QString name;
+    QJsonParseError parseError{};
+    QJsonDocument response = QJsonDocument::fromJson(body, &parseError);
+    if (parseError.error == QJsonParseError::NoError && response.isObject()) {
+        QJsonObject json = response.object();
+        name = json[QStringLiteral("name")].toString();
+        result.deleteToken =
+          historyValue(json[QStringLiteral("token")].toString());
+    } else {
+        name = QString::fromUtf8(body).trimmed();
+    }
+    if (name.isEmpty()) {
+        error = tr("The server did not answer with the name of the image");
+        return false;
+    }
+    result.name = historyValue(name);
+    result.url = link(result.name);
+    return true;
+}
+
+void HttpUploader::deleteImage(const QString& fileName,
+                               const QString& deleteToken)
+{
+    QString url = ConfigHandler().uploadHttpDeleteUrl();
+    if (url.isEmpty()) {
+        // The image can only be removed from the history
+        emit deleteOk();
+        return;
+    }
+    url = fillTemplate(url, QStringLiteral("{name}"), fileName);
+    url = fillTemplate(url, QStringLiteral("{token}"), deleteToken);
+
+    QNetworkRequest request{ QUrl(url) };
+    authorize(request);
+    QNetworkReply* reply =
+      UploadQueue::instance()->networkManager()->deleteResource(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        reply->deleteLater();
+        if (reply->error() != QNetworkReply::NoError) {
+            AbstractLogger::error()
+              << tr("Unable to delete the image from the server: %1")
+                   .arg(reply->errorString());
+            return;
+        }
+        emit deleteOk();
+    });
+}
+
+void HttpUploader::authorize(QNetworkRequest& request)
+{
+    QString authorization = ConfigHandler().uploadHttpAuthorization();
+    if (!authorization.isEmpty()) {
+        request.setRawHeader("Authorization", authorization.toUtf8());
+    }
+}
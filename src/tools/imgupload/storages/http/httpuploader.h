@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/imgupload/storages/imguploaderbase.h"
+#include "src/tools/imgupload/uploadqueue.h"
+
+#define HTTP_UPLOADER_STORAGE "http"
+
+class QNetworkReply;
+class QNetworkAccessManager;
+class QNetworkRequest;
+
+/**
+ * @brief Uploads to a self-hosted image store over plain HTTP.
+ *
+ * The image is posted as multipart/form-data to `uploadHttpUrl`. The server
+ * answers with the name of the image, either as plain text or as the "name"
+ * of a JSON object that can also hold a "token" to delete it with, and the
+ * link to the image is made from the `uploadHttpLink` template.
+ */
+class HttpUploader : public ImgUploaderBase
+{
+    Q_OBJECT
+public:
+    explicit HttpUploader(const QPixmap& capture, QWidget* parent = nullptr);
+    void deleteImage(const QString& fileName, const QString& deleteToken);
+
+    static QString link(const QString& name);
+    static QNetworkReply* send(QNetworkAccessManager* networkAM,
+                               QIODevice* image,
+                               const QString& format);
+    static bool parseReply(QNetworkReply* reply,
+                           UploadResult& result,
+                           QString& error);
+
+private:
+    QString storage() const;
+    static void authorize(QNetworkRequest& request);
+};
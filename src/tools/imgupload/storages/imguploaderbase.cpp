@@ -3,6 +3,7 @@
 
 #include "imguploaderbase.h"
 #include "src/core/flameshotdaemon.h"
+#include "src/tools/imgupload/uploadqueue.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/globalvalues.h"
 #include "src/utils/history.h"
@@ -29,6 +30,7 @@
 #include <QTimer>
 #include <QUrlQuery>
 #include <QVBoxLayout>
+#include <QtMath>
 
 ImgUploaderBase::ImgUploaderBase(const QPixmap& capture, QWidget* parent)
   : QWidget(parent)
@@ -55,6 +57,7 @@ ImgUploaderBase::ImgUploaderBase(const QPixmap& capture, QWidget* parent)
     m_vLayout->addWidget(m_spinner, 0, Qt::AlignHCenter);
     m_vLayout->addWidget(m_infoLabel);
 
+    connectQueue();
     setAttribute(Qt::WA_DeleteOnClose);
 }
 
@@ -93,6 +96,68 @@ void ImgUploaderBase::setInfoLabelText(const QString& text)
     m_infoLabel->setText(text);
 }
 
+/**
+ * @brief Hand the capture to UploadQueue, the window follows its upload.
+ */
+void ImgUploaderBase::upload()
+{
+    m_jobId = UploadQueue::instance()->enqueue(storage(), m_pixmap.toImage());
+}
+
+void ImgUploaderBase::connectQueue()
+{
+    UploadQueue* queue = UploadQueue::instance();
+    connect(queue,
+            &UploadQueue::progress,
+            this,
+            [this](const QString& id, qint64 bytesSent, qint64 bytesTotal) {
+                if (id != m_jobId) {
+                    return;
+                }
+                if (bytesTotal > 0) {
+                    setInfoLabelText(tr("Uploading Image (%1%)")
+                                       .arg(bytesSent * 100 / bytesTotal));
+                }
+                emit uploadProgress(bytesSent, bytesTotal);
+            });
+    connect(queue,
+            &UploadQueue::retrying,
+            this,
+            [this](const QString& id, const QString& error, int delay) {
+                if (id == m_jobId) {
+                    setInfoLabelText(tr("%1\nRetrying in %2 s")
+                                       .arg(error)
+                                       .arg(qCeil(delay / 1000.0)));
+                }
+            });
+    connect(queue,
+            &UploadQueue::finished,
+            this,
+            [this](const QString& id,
+                   const UploadResult& result,
+                   const QString& historyName) {
+                if (id != m_jobId) {
+                    return;
+                }
+                m_spinner->deleteLater();
+                new QShortcut(Qt::Key_Escape, this, SLOT(close()));
+                setImageURL(result.url);
+                m_currentImageName = historyName;
+                emit uploadOk(result.url);
+            });
+    connect(queue,
+            &UploadQueue::failed,
+            this,
+            [this](const QString& id, const QString& error) {
+                if (id != m_jobId) {
+                    return;
+                }
+                m_spinner->deleteLater();
+                new QShortcut(Qt::Key_Escape, this, SLOT(close()));
+                setInfoLabelText(error);
+            });
+}
+
 void ImgUploaderBase::startDrag()
 {
     auto* mimeData = new QMimeData;
@@ -179,6 +244,13 @@ void ImgUploaderBase::deleteCurrentImage()
 {
     History history;
     HistoryFileName unpackFileName = history.unpackFileName(m_currentImageName);
+    // Later uploads of the same image must not end with the deleted one
+    connect(
+      this,
+      &ImgUploaderBase::deleteOk,
+      this,
+      [name = m_currentImageName]() { History().remove(name); },
+      Qt::SingleShotConnection);
     deleteImage(unpackFileName.file, unpackFileName.token);
 }
 
@@ -33,10 +33,11 @@ public:
     NotificationWidget* notification();
     virtual void deleteImage(const QString& fileName,
                              const QString& deleteToken) = 0;
-    virtual void upload() = 0;
+    void upload();
 
 signals:
     void uploadOk(const QUrl& url);
+    void uploadProgress(qint64 bytesSent, qint64 bytesTotal);
     void deleteOk();
 
 public slots:
@@ -51,7 +52,13 @@ private slots:
     void saveScreenshotToFilesystem();
 
 private:
+    // Name of the storage in the history
+    virtual QString storage() const = 0;
+    void connectQueue();
+
     QPixmap m_pixmap;
+    // Of the upload in UploadQueue
+    QString m_jobId;
 
     QVBoxLayout* m_vLayout;
     QHBoxLayout* m_hLayout;
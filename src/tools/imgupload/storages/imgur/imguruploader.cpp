@@ -2,12 +2,10 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "imguruploader.h"
+#include "src/tools/imgupload/imguploadermanager.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
-#include "src/utils/history.h"
-#include "src/widgets/loadspinner.h"
 #include "src/widgets/notificationwidget.h"
-#include <QBuffer>
 #include <QDesktopServices>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -15,70 +13,20 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
-#include <QShortcut>
 #include <QUrlQuery>
 
 ImgurUploader::ImgurUploader(const QPixmap& capture, QWidget* parent)
   : ImgUploaderBase(capture, parent)
-{
-    m_NetworkAM = new QNetworkAccessManager(this);
-    connect(m_NetworkAM,
-            &QNetworkAccessManager::finished,
-            this,
-            &ImgurUploader::handleReply);
-}
+{}
 
-void ImgurUploader::handleReply(QNetworkReply* reply)
+QString ImgurUploader::storage() const
 {
-    spinner()->deleteLater();
-    m_currentImageName.clear();
-    QJsonDocument response = QJsonDocument::fromJson(reply->readAll());
-    QJsonObject json = response.object();
-    if (reply->error() == QNetworkReply::NoError) {
-        QJsonObject data = json[QStringLiteral("data")].toObject();
-        setImageURL(data[QStringLiteral("link")].toString());
-
-        auto deleteToken = data[QStringLiteral("deletehash")].toString();
-
-        // save history
-        m_currentImageName = imageURL().toString();
-        int lastSlash = m_currentImageName.lastIndexOf("/");
-        if (lastSlash >= 0) {
-            m_currentImageName = m_currentImageName.mid(lastSlash + 1);
-        }
-
-        // save image to history
-        History history;
-        m_currentImageName =
-          history.packFileName("imgur", deleteToken, m_currentImageName);
-        history.save(pixmap(), m_currentImageName);
-
-        emit uploadOk(imageURL());
-    } else {
-        QString status;
-        if (json.contains(QStringLiteral("errors")) &&
-            json.value(QStringLiteral("errors")).isArray()) {
-            QJsonArray errorsArray =
-              json.value(QStringLiteral("errors")).toArray();
-            if (!errorsArray.isEmpty() && errorsArray.at(0).isObject()) {
-                QJsonObject errorObj = errorsArray.at(0).toObject();
-                status = errorObj.value(QStringLiteral("code")).toString() +
-                         " - " +
-                         errorObj.value(QStringLiteral("status")).toString();
-            }
-        }
-
-        setInfoLabelText(reply->errorString() + "\n" + status);
-    }
-    new QShortcut(Qt::Key_Escape, this, SLOT(close()));
+    return QStringLiteral(IMG_UPLOADER_STORAGE_DEFAULT);
 }
 
-void ImgurUploader::upload()
+QNetworkReply* ImgurUploader::send(QNetworkAccessManager* networkAM,
+                                   QIODevice* image)
 {
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    pixmap().save(&buffer, "PNG");
-
     QUrlQuery urlQuery;
     urlQuery.addQueryItem(QStringLiteral("title"), QStringLiteral(""));
     QString description = FileNameHandler().parsedPattern();
@@ -94,7 +42,39 @@ void ImgurUploader::upload()
                            .arg(ConfigHandler().uploadClientSecret())
                            .toUtf8());
 
-    m_NetworkAM->post(request, byteArray);
+    return networkAM->post(request, image);
+}
+
+bool ImgurUploader::parseReply(QNetworkReply* reply,
+                               UploadResult& result,
+                               QString& error)
+{
+    QJsonDocument response = QJsonDocument::fromJson(reply->readAll());
+    QJsonObject json = response.object();
+    if (reply->error() == QNetworkReply::NoError) {
+        QJsonObject data = json[QStringLiteral("data")].toObject();
+        result.url = data[QStringLiteral("link")].toString();
+        result.deleteToken = data[QStringLiteral("deletehash")].toString();
+        result.name = result.url.toString();
+        int lastSlash = result.name.lastIndexOf("/");
+        if (lastSlash >= 0) {
+            result.name = result.name.mid(lastSlash + 1);
+        }
+        return true;
+    }
+
+    QString status;
+    if (json.contains(QStringLiteral("errors")) &&
+        json.value(QStringLiteral("errors")).isArray()) {
+        QJsonArray errorsArray = json.value(QStringLiteral("errors")).toArray();
+        if (!errorsArray.isEmpty() && errorsArray.at(0).isObject()) {
+            QJsonObject errorObj = errorsArray.at(0).toObject();
+            status = errorObj.value(QStringLiteral("code")).toString() + " - " +
+                     errorObj.value(QStringLiteral("status")).toString();
+        }
+    }
+    error = reply->errorString() + "\n" + status;
+    return false;
 }
 
 void ImgurUploader::deleteImage(const QString& fileName,
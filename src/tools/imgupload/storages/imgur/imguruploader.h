@@ -4,6 +4,7 @@
 #pragma once
 
 #include "src/tools/imgupload/storages/imguploaderbase.h"
+#include "src/tools/imgupload/uploadqueue.h"
 #include <QUrl>
 #include <QWidget>
 
@@ -18,12 +19,12 @@ public:
     explicit ImgurUploader(const QPixmap& capture, QWidget* parent = nullptr);
     void deleteImage(const QString& fileName, const QString& deleteToken);
 
-private slots:
-    void handleReply(QNetworkReply* reply);
+    static QNetworkReply* send(QNetworkAccessManager* networkAM,
+                               QIODevice* image);
+    static bool parseReply(QNetworkReply* reply,
+                           UploadResult& result,
+                           QString& error);
 
 private:
-    void upload();
-
-private:
-    QNetworkAccessManager* m_NetworkAM;
+    QString storage() const;
 };
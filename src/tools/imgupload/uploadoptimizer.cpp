@@ -0,0 +1,261 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "uploadoptimizer.h"
+#include <QBuffer>
+#include <QThreadPool>
+#include <QVector>
+#include <QtMath>
+#include <algorithm>
+#include <functional>
+
+// Side of the square windows SSIM is computed over
+#define SSIM_WINDOW 8
+
+namespace {
+
+const int JPEG_QUALITIES[] = { 90, 80, 70, 60, 50 };
+
+EncodedImage encodeAs(const QImage& image,
+                      const char* format,
+                      int quality,
+                      const QString& encoding)
+{
+    EncodedImage encoded;
+    QBuffer buffer(&encoded.data);
+    buffer.open(QIODevice::WriteOnly);
+    // No data when the encoder failed, like without its image plugin
+    if (!image.save(&buffer, format, quality)) {
+        encoded.data.clear();
+    }
+    encoded.format = QString::fromLatin1(format);
+    encoded.encoding = encoding;
+    return encoded;
+}
+
+// Luma and chroma of a 32 bit pixel, in the 0-255 range
+inline int luma(QRgb pixel)
+{
+    return (qRed(pixel) * 77 + qGreen(pixel) * 150 + qBlue(pixel) * 29) >> 8;
+}
+
+inline int blueChroma(QRgb pixel)
+{
+    return 128 +
+           ((-qRed(pixel) * 43 - qGreen(pixel) * 85 + qBlue(pixel) * 128) >> 8);
+}
+
+inline int redChroma(QRgb pixel)
+{
+    return 128 +
+           ((qRed(pixel) * 128 - qGreen(pixel) * 107 - qBlue(pixel) * 21) >> 8);
+}
+
+// Mean SSIM of one channel over non-overlapping windows, -1 when the images
+// are smaller than a window
+double channelSsim(const QImage& x, const QImage& y, int (*channel)(QRgb))
+{
+    const double c1 = (0.01 * 255) * (0.01 * 255);
+    const double c2 = (0.03 * 255) * (0.03 * 255);
+    const int n = SSIM_WINDOW * SSIM_WINDOW;
+
+    double total = 0;
+    int windows = 0;
+    for (int top = 0; top + SSIM_WINDOW <= x.height(); top += SSIM_WINDOW) {
+        for (int left = 0; left + SSIM_WINDOW <= x.width();
+             left += SSIM_WINDOW) {
+            qint64 sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+            for (int row = top; row < top + SSIM_WINDOW; ++row) {
+                auto* lineX =
+                  reinterpret_cast<const QRgb*>(x.constScanLine(row));
+                auto* lineY =
+                  reinterpret_cast<const QRgb*>(y.constScanLine(row));
+                for (int col = left; col < left + SSIM_WINDOW; ++col) {
+                    const int vx = channel(lineX[col]);
+                    const int vy = channel(lineY[col]);
+                    sx += vx;
+                    sy += vy;
+                    sxx += vx * vx;
+                    syy += vy * vy;
+                    sxy += vx * vy;
+                }
+            }
+            const double mx = double(sx) / n;
+            const double my = double(sy) / n;
+            const double vx = double(sxx) / n - mx * mx;
+            const double vy = double(syy) / n - my * my;
+            const double cov = double(sxy) / n - mx * my;
+            total += ((2 * mx * my + c1) * (2 * cov + c2)) /
+                     ((mx * mx + my * my + c1) * (vx + vy + c2));
+            ++windows;
+        }
+    }
+    return windows == 0 ? -1 : total / windows;
+}
+
+// Whether JPEG, which has no alpha channel, can encode the image
+bool isOpaque(const QImage& image)
+{
+    if (!image.hasAlphaChannel()) {
+        return true;
+    }
+    const QImage argb = image.convertToFormat(QImage::Format_ARGB32);
+    for (int y = 0; y < argb.height(); ++y) {
+        auto* line = reinterpret_cast<const QRgb*>(argb.constScanLine(y));
+        for (int x = 0; x < argb.width(); ++x) {
+            if (qAlpha(line[x]) != 255) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool fitsIn(const EncodedImage& encoded, qint64 maxBytes)
+{
+    return maxBytes <= 0 || encoded.data.size() <= maxBytes;
+}
+
+} // unnamed namespace
+
+UploadOptimizer::UploadOptimizer(qint64 maxBytes,
+                                 qint64 maxPixels,
+                                 double minQuality)
+  : m_maxBytes(maxBytes)
+  , m_maxPixels(maxPixels)
+  , m_minQuality(minQuality)
+{}
+
+/**
+ * @brief The encoding of `image` to upload. Called from worker threads.
+ */
+EncodedImage UploadOptimizer::encode(const QImage& image) const
+{
+    QImage base = image;
+    QString scale;
+    const qint64 pixels = qint64(image.width()) * image.height();
+    if (m_maxPixels > 0 && pixels > m_maxPixels) {
+        double factor = qSqrt(double(m_maxPixels) / pixels);
+        base = image.scaled(qMax(1, int(image.width() * factor)),
+                            qMax(1, int(image.height() * factor)),
+                            Qt::IgnoreAspectRatio,
+                            Qt::SmoothTransformation);
+        scale = QStringLiteral(" %1x%2").arg(base.width()).arg(base.height());
+    }
+
+    EncodedImage png = encodeAs(base, "png", -1, "png" + scale);
+    if (fitsIn(png, m_maxBytes)) {
+        return png;
+    }
+
+    QVector<std::function<EncodedImage()>> candidates;
+    candidates << [&]() {
+        return encodeAs(base.convertToFormat(QImage::Format_Indexed8),
+                        "png",
+                        -1,
+                        "png palette" + scale);
+    };
+    const bool opaque = isOpaque(base);
+    if (opaque) {
+        for (int quality : JPEG_QUALITIES) {
+            candidates << [&, quality]() {
+                return encodeAs(base,
+                                "jpeg",
+                                quality,
+                                QStringLiteral("jpeg q%1").arg(quality) +
+                                  scale);
+            };
+        }
+    }
+    const qreal ratio = image.devicePixelRatio();
+    if (ratio > 1) {
+        QImage logical =
+          base.scaled((base.size() / ratio).expandedTo({ 1, 1 }),
+                      Qt::IgnoreAspectRatio,
+                      Qt::SmoothTransformation);
+        QString ratioScale = QStringLiteral(" 1/%1").arg(ratio);
+        candidates << [=]() {
+            return encodeAs(logical, "png", -1, "png" + ratioScale);
+        };
+        if (opaque) {
+            candidates << [=]() {
+                return encodeAs(
+                  logical, "jpeg", JPEG_QUALITIES[0], "jpeg q90" + ratioScale);
+            };
+        }
+    }
+
+    // Each candidate is encoded, decoded and compared on its own thread
+    QVector<EncodedImage> encoded(candidates.size());
+    QThreadPool pool;
+    for (int i = 0; i < candidates.size(); ++i) {
+        pool.start([&, i]() {
+            encoded[i] = candidates[i]();
+            QImage decoded = QImage::fromData(encoded[i].data);
+            if (decoded.size() != base.size()) {
+                decoded = decoded.scaled(
+                  base.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            }
+            encoded[i].quality = ssim(base, decoded);
+        });
+    }
+    pool.waitForDone();
+
+    encoded.prepend(png);
+    // An empty candidate would always fit
+    encoded.removeIf(
+      [](const EncodedImage& candidate) { return candidate.data.isEmpty(); });
+    if (encoded.isEmpty()) {
+        return png;
+    }
+    return *std::min_element(
+      encoded.begin(),
+      encoded.end(),
+      [this](const EncodedImage& a, const EncodedImage& b) {
+          return isBetter(a, b);
+      });
+}
+
+// The smallest encoding that fits and looks close enough, or else the best
+// looking one that fits, or else the smallest
+bool UploadOptimizer::isBetter(const EncodedImage& a,
+                               const EncodedImage& b) const
+{
+    const bool aFits = fitsIn(a, m_maxBytes);
+    const bool bFits = fitsIn(b, m_maxBytes);
+    if (aFits != bFits) {
+        return aFits;
+    }
+    const bool aGood = a.quality >= m_minQuality;
+    const bool bGood = b.quality >= m_minQuality;
+    if (aFits && aGood != bGood) {
+        return aGood;
+    }
+    if (aFits && !aGood) {
+        return a.quality > b.quality;
+    }
+    return a.data.size() < b.data.size();
+}
+
+/**
+ * @brief Mean structural similarity of two images of the same size, over
+ * non-overlapping windows. 1 when they are identical.
+ *
+ * The luma and both chroma channels are compared, weighted 4:1:1 like the
+ * planes of 4:2:0 video, so that the colours a palette loses count too.
+ */
+double UploadOptimizer::ssim(const QImage& reference, const QImage& image)
+{
+    if (reference.size() != image.size() || image.isNull()) {
+        return 0;
+    }
+    const QImage x = reference.convertToFormat(QImage::Format_RGB32);
+    const QImage y = image.convertToFormat(QImage::Format_RGB32);
+    const double lumaSsim = channelSsim(x, y, luma);
+    if (lumaSsim < 0) {
+        return x == y ? 1 : 0;
+    }
+    return (4 * lumaSsim + channelSsim(x, y, blueChroma) +
+            channelSsim(x, y, redChroma)) /
+           6;
+}
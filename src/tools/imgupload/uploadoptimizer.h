@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+struct EncodedImage
+{
+    QByteArray data;
+    // Image format, as given to QImageWriter
+    QString format;
+    // How the image was encoded, like "jpeg q80 1/2"
+    QString encoding;
+    // SSIM against the image that was encoded, 1 when lossless
+    double quality{ 1.0 };
+};
+
+/**
+ * @brief Encodes an image to upload within a size budget.
+ *
+ * Without a budget, or when the PNG of the image fits in it, the image is
+ * sent as PNG. Otherwise a few encodings are tried in parallel, a palette
+ * PNG, JPEG at decreasing qualities and the image downscaled by its device
+ * pixel ratio, and the smallest one that still looks close enough to the
+ * image, by SSIM, is kept. Images with more pixels than allowed are always
+ * downscaled first.
+ */
+class UploadOptimizer
+{
+public:
+    // Budgets of 0 are not enforced
+    UploadOptimizer(qint64 maxBytes, qint64 maxPixels, double minQuality);
+
+    EncodedImage encode(const QImage& image) const;
+
+    static double ssim(const QImage& reference, const QImage& image);
+
+private:
+    bool isBetter(const EncodedImage& a, const EncodedImage& b) const;
+
+    qint64 m_maxBytes;
+    qint64 m_maxPixels;
+    double m_minQuality;
+};
@@ -0,0 +1,364 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "uploadqueue.h"
+#include "abstractlogger.h"
+#include "imguploadermanager.h"
+#include "src/core/flameshotdaemon.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/history.h"
+#include "uploadoptimizer.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+
+// Uploads sent at the same time
+#define UPLOAD_MAX_RUNNING 2
+// Attempts of a job before it is given up, in a single process
+#define UPLOAD_MAX_ATTEMPTS 6
+// Delay before the first retry, doubled for each of the next ones, in ms
+#define UPLOAD_RETRY_DELAY 1000
+#define UPLOAD_RETRY_MAX_DELAY 60000
+
+namespace {
+
+// Failures that may not happen again: the network, an overloaded server
+bool isTransient(QNetworkReply* reply)
+{
+    if (reply->error() == QNetworkReply::OperationCanceledError) {
+        return false;
+    }
+    int status =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return status == 0 || status == 429 || status >= 500;
+}
+
+// The delay before attempt `attempts` + 1, with a quarter of jitter so that
+// the jobs that failed together are not retried together
+int retryDelay(int attempts)
+{
+    int delay = qMin(UPLOAD_RETRY_DELAY << qMin(attempts - 1, 16),
+                     UPLOAD_RETRY_MAX_DELAY);
+    return delay - QRandomGenerator::global()->bounded(delay / 4 + 1);
+}
+
+} // unnamed namespace
+
+UploadQueue::UploadQueue(QObject* parent)
+  : QObject(parent)
+  , m_directory(
+      QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+      "/flameshot/uploads/")
+{
+    QDir().mkpath(m_directory);
+    m_encoder.setMaxThreadCount(1);
+}
+
+UploadQueue::~UploadQueue()
+{
+    // The jobs stay on disk, to be resumed by the daemon
+    m_encoder.waitForDone();
+}
+
+UploadQueue* UploadQueue::instance()
+{
+    static UploadQueue* queue = new UploadQueue(QCoreApplication::instance());
+    return queue;
+}
+
+QNetworkAccessManager* UploadQueue::networkManager()
+{
+    return &m_networkAM;
+}
+
+/**
+ * @brief Upload `image` to `storage`.
+ *
+ * The image is looked up in the history, then encoded in the background,
+ * within the upload budgets of the config, and written to disk before it is
+ * sent, so that the upload survives the process.
+ * @return The id of the job, that the signals are emitted with
+ */
+QString UploadQueue::enqueue(const QString& storage, const QImage& image)
+{
+    // Sorts the jobs by age when they are resumed
+    QString id =
+      QDateTime::currentDateTimeUtc().toString("yyyyMMdd-hhmmsszzz-") +
+      QString::number(QRandomGenerator::global()->generate(), 16);
+
+    Job job;
+    job.storage = storage;
+    job.image = image;
+    job.lock = jobLock(id);
+    job.lock->tryLock(0);
+    m_jobs.insert(id, job);
+
+    History::findUpload(
+      image,
+      storage,
+      this,
+      [this, id](const QByteArray& hash, const HistoryEntry& existing) {
+          onHashed(id, hash, existing);
+      });
+    return id;
+}
+
+void UploadQueue::onHashed(const QString& id,
+                           const QByteArray& hash,
+                           const HistoryEntry& existing)
+{
+    if (!m_jobs.contains(id)) {
+        return;
+    }
+    if (existing.file.isEmpty()) {
+        m_jobs[id].hash = hash;
+        encode(id);
+        return;
+    }
+
+    UploadResult result;
+    result.url =
+      QUrl(ImgUploaderManager::link(existing.storage, existing.remoteName));
+    result.name = existing.remoteName;
+    result.deleteToken = existing.token;
+    removeJob(id);
+    emit finished(id, result, existing.file);
+}
+
+void UploadQueue::encode(const QString& id)
+{
+    Job job = m_jobs.value(id);
+    ConfigHandler config;
+    UploadOptimizer optimizer(config.uploadMaxBytes(),
+                              config.uploadMaxPixels(),
+                              config.uploadMinQuality() / 100.0);
+    QString imagePath = path(id, ".img");
+    m_encoder.start([this, id, job, imagePath, optimizer]() mutable {
+        EncodedImage image = optimizer.encode(job.image);
+        job.format = image.format;
+        job.encoding = image.encoding;
+        job.uploadSize = image.data.size();
+        QSaveFile file(imagePath);
+        bool encoded = !image.data.isEmpty() &&
+                       file.open(QIODevice::WriteOnly) &&
+                       file.write(image.data) == image.data.size() &&
+                       file.commit() && writeManifest(id, job);
+        QMetaObject::invokeMethod(this, [this, id, encoded, job]() {
+            onEncoded(id, encoded, job.format, job.encoding, job.uploadSize);
+        });
+    });
+}
+
+/**
+ * @brief Send the jobs left over by processes that are gone.
+ */
+void UploadQueue::resume()
+{
+    QDir directory(m_directory);
+    const QStringList manifests =
+      directory.entryList({ "*.json" }, QDir::Files, QDir::Name);
+    for (const QString& manifest : manifests) {
+        QString id = manifest.chopped(5);
+        if (m_jobs.contains(id)) {
+            continue;
+        }
+        Job job;
+        job.resumed = true;
+        job.lock = jobLock(id);
+        // Still sent by a running process
+        if (!job.lock->tryLock(0)) {
+            continue;
+        }
+
+        QFile file(path(id, ".json"));
+        QJsonObject json;
+        if (file.open(QIODevice::ReadOnly)) {
+            json = QJsonDocument::fromJson(file.readAll()).object();
+        }
+        job.storage = json["storage"].toString();
+        job.attempts = json["attempts"].toInt();
+        job.format = json["format"].toString(QStringLiteral("png"));
+        job.encoding = json["encoding"].toString();
+        job.uploadSize = json["uploadSize"].toInteger();
+        job.hash = QByteArray::fromHex(json["hash"].toString().toLatin1());
+        if (job.storage.isEmpty() || !QFile::exists(path(id, ".img"))) {
+            QFile::remove(path(id, ".img"));
+            QFile::remove(path(id, ".json"));
+            continue;
+        }
+        m_jobs.insert(id, job);
+        m_pending.enqueue(id);
+    }
+
+    // Images whose process exited before their manifest was written
+    const QStringList images =
+      directory.entryList({ "*.img" }, QDir::Files, QDir::Name);
+    for (const QString& image : images) {
+        QString id = image.chopped(4);
+        if (!m_jobs.contains(id) && !QFile::exists(path(id, ".json")) &&
+            jobLock(id)->tryLock(0)) {
+            QFile::remove(path(id, ".img"));
+        }
+    }
+
+    if (!m_pending.isEmpty()) {
+        AbstractLogger::info()
+          << tr("Resuming %1 pending uploads").arg(m_pending.size());
+    }
+    startNext();
+}
+
+QString UploadQueue::path(const QString& id, const QString& suffix) const
+{
+    return m_directory + id + suffix;
+}
+
+// Held by the process that sends the job, the others leave it alone
+QSharedPointer<QLockFile> UploadQueue::jobLock(const QString& id) const
+{
+    QSharedPointer<QLockFile> lock(new QLockFile(path(id, ".lock")));
+    // Only the lock of a process that is gone is stale, however old it is
+    lock->setStaleLockTime(0);
+    return lock;
+}
+
+bool UploadQueue::writeManifest(const QString& id, const Job& job) const
+{
+    QJsonObject json{ { "storage", job.storage },
+                      { "attempts", job.attempts },
+                      { "format", job.format },
+                      { "encoding", job.encoding },
+                      { "uploadSize", job.uploadSize },
+                      { "hash", QString::fromLatin1(job.hash.toHex()) } };
+    QSaveFile file(path(id, ".json"));
+    return file.open(QIODevice::WriteOnly) &&
+           file.write(QJsonDocument(json).toJson()) >= 0 && file.commit();
+}
+
+void UploadQueue::onEncoded(const QString& id,
+                            bool encoded,
+                            const QString& format,
+                            const QString& encoding,
+                            qint64 uploadSize)
+{
+    if (!encoded) {
+        fail(id, tr("Unable to write the image to upload"));
+        return;
+    }
+    Job& job = m_jobs[id];
+    job.format = format;
+    job.encoding = encoding;
+    job.uploadSize = uploadSize;
+    m_pending.enqueue(id);
+    startNext();
+}
+
+void UploadQueue::startNext()
+{
+    while (m_running < UPLOAD_MAX_RUNNING && !m_pending.isEmpty()) {
+        send(m_pending.dequeue());
+    }
+}
+
+void UploadQueue::send(const QString& id)
+{
+    Job& job = m_jobs[id];
+    job.file = new QFile(path(id, ".img"), this);
+    if (!job.file->open(QIODevice::ReadOnly)) {
+        fail(id, tr("Unable to read the image to upload"));
+        return;
+    }
+    QNetworkReply* reply =
+      ImgUploaderManager::send(job.storage, &m_networkAM, job.file, job.format);
+    if (reply == nullptr) {
+        fail(id, tr("Unknown upload storage %1").arg(job.storage));
+        return;
+    }
+
+    ++m_running;
+    connect(reply,
+            &QNetworkReply::uploadProgress,
+            this,
+            [this, id](qint64 bytesSent, qint64 bytesTotal) {
+                emit progress(id, bytesSent, bytesTotal);
+            });
+    connect(reply, &QNetworkReply::finished, this, [this, id, reply]() {
+        onReplyFinished(id, reply);
+    });
+}
+
+void UploadQueue::onReplyFinished(const QString& id, QNetworkReply* reply)
+{
+    reply->deleteLater();
+    --m_running;
+    Job& job = m_jobs[id];
+    job.file->deleteLater();
+    job.file = nullptr;
+
+    UploadResult result;
+    QString error;
+    if (ImgUploaderManager::parseReply(job.storage, reply, result, error)) {
+        complete(id, result);
+    } else if (isTransient(reply) && ++job.attempts < UPLOAD_MAX_ATTEMPTS) {
+        writeManifest(id, job);
+        int delay = retryDelay(job.attempts);
+        emit retrying(id, error, delay);
+        QTimer::singleShot(delay, this, [this, id]() {
+            m_pending.enqueue(id);
+            startNext();
+        });
+    } else {
+        fail(id, error);
+    }
+    startNext();
+}
+
+void UploadQueue::complete(const QString& id, const UploadResult& result)
+{
+    Job job = m_jobs.value(id);
+    History history;
+    QString historyName =
+      history.packFileName(job.storage, result.deleteToken, result.name);
+    QImage image = job.image.isNull() ? QImage(path(id, ".img")) : job.image;
+    history.save(image, historyName, job.encoding, job.uploadSize, job.hash);
+
+    if (job.resumed) {
+        if (ConfigHandler().copyURLAfterUpload()) {
+            FlameshotDaemon::copyToClipboard(
+              result.url.toString(), tr("URL copied to clipboard."));
+        } else {
+            AbstractLogger::info()
+              << tr("Uploaded %1").arg(result.url.toString());
+        }
+    }
+    removeJob(id);
+    emit finished(id, result, historyName);
+}
+
+void UploadQueue::fail(const QString& id, const QString& error)
+{
+    if (m_jobs.value(id).resumed) {
+        AbstractLogger::error() << tr("Upload failed: %1").arg(error);
+    }
+    removeJob(id);
+    emit failed(id, error);
+}
+
+void UploadQueue::removeJob(const QString& id)
+{
+    Job job = m_jobs.take(id);
+    if (job.file != nullptr) {
+        job.file->deleteLater();
+    }
+    QFile::remove(path(id, ".img"));
+    QFile::remove(path(id, ".json"));
+    job.lock->unlock();
+}
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QLockFile>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QUrl>
+
+class QFile;
+class QNetworkReply;
+struct HistoryEntry;
+
+// What a storage answered to an upload
+struct UploadResult
+{
+    QUrl url;
+    // Name of the image on the storage
+    QString name;
+    QString deleteToken;
+};
+
+/**
+ * @brief Sends the uploads of the process, whatever storage they go to.
+ *
+ * Every upload is a job: the encoded image and a small manifest in the
+ * uploads cache directory, locked by the process that sends it. Only a few
+ * jobs are sent at a time, through one network manager. A job that failed
+ * because of the network or the server is retried after a delay that doubles
+ * with every attempt. An image that is already in the history of the storage
+ * is not sent again, the job ends with its earlier upload. Jobs left over by
+ * a process that exited are resumed by the daemon when it starts. A finished
+ * job is added to the history and its files are removed.
+ */
+class UploadQueue : public QObject
+{
+    Q_OBJECT
+public:
+    static UploadQueue* instance();
+    ~UploadQueue();
+
+    QNetworkAccessManager* networkManager();
+
+    QString enqueue(const QString& storage, const QImage& image);
+    void resume();
+
+signals:
+    void progress(const QString& id, qint64 bytesSent, qint64 bytesTotal);
+    void retrying(const QString& id, const QString& error, int delay);
+    // `historyName` is the name of the upload in the history
+    void finished(const QString& id,
+                  const UploadResult& result,
+                  const QString& historyName);
+    void failed(const QString& id, const QString& error);
+
+private:
+    struct Job
+    {
+        QString storage;
+        int attempts{ 0 };
+        // Of the encoded image, see UploadOptimizer
+        QString format;
+        QString encoding;
+        qint64 uploadSize{ 0 };
+        // Of the pixels, see History::imageHash()
+        QByteArray hash;
+        // Left over by another process, nobody is waiting for it
+        bool resumed{ false };
+        // Kept until the job ends, for the history thumbnail
+        QImage image;
+        QSharedPointer<QLockFile> lock;
+        QFile* file{ nullptr };
+    };
+
+    explicit UploadQueue(QObject* parent = nullptr);
+
+    QString path(const QString& id, const QString& suffix) const;
+    QSharedPointer<QLockFile> jobLock(const QString& id) const;
+    bool writeManifest(const QString& id, const Job& job) const;
+    void onHashed(const QString& id,
+                  const QByteArray& hash,
+                  const HistoryEntry& existing);
+    void encode(const QString& id);
+    void onEncoded(const QString& id,
+                   bool encoded,
+                   const QString& format,
+                   const QString& encoding,
+                   qint64 uploadSize);
+    void startNext();
+    void send(const QString& id);
+    void onReplyFinished(const QString& id, QNetworkReply* reply);
+    void complete(const QString& id, const UploadResult& result);
+    void fail(const QString& id, const QString& error);
+    void removeJob(const QString& id);
+
+    QString m_directory;
+    QNetworkAccessManager m_networkAM;
+    QHash<QString, Job> m_jobs;
+    QQueue<QString> m_pending;
+    int m_running{ 0 };
+    QThreadPool m_encoder;
+};
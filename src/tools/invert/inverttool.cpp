@@ -2,11 +2,6 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "inverttool.h"
-#include <QApplication>
-#include <QGraphicsBlurEffect>
-#include <QGraphicsPixmapItem>
-#include <QGraphicsScene>
-#include <QImage>
 #include <QPainter>
 #include <QPixmap>
 
@@ -50,16 +45,14 @@ CaptureTool* InvertTool::copy(QObject* parent)
 void InvertTool::process(QPainter& painter, const QPixmap& pixmap)
 {
     QRect selection = boundingRect().intersected(pixmap.rect());
-    auto pixelRatio = pixmap.devicePixelRatio();
-    QRect selectionScaled = QRect(selection.topLeft() * pixelRatio,
-                                  selection.bottomRight() * pixelRatio);
 
-    // Invert selection
-    QPixmap inv = pixmap.copy(selectionScaled);
-    QImage img = inv.toImage();
-    img.invertPixels();
-
-    painter.drawImage(selection, img);
+    // Invert selection in place on the painted device. XOR-ing with white
+    // flips the RGB channels and leaves alpha untouched, like
+    // QImage::invertPixels(), without copying the region out and back.
+    const auto compositionMode = painter.compositionMode();
+    painter.setCompositionMode(QPainter::RasterOp_SourceXorDestination);
+    painter.fillRect(selection, QColor(Qt::white));
+    painter.setCompositionMode(compositionMode);
 }
 
 void InvertTool::drawSearchArea(QPainter& painter, const QPixmap& pixmap)
@@ -3,22 +3,28 @@
 
 #include "applauncherwidget.h"
 #include "src/tools/launcher/launcheritemdelegate.h"
+#include "src/tools/launcher/launchersearchmodel.h"
 #include "src/utils/confighandler.h"
+#include "src/utils/desktopentryindex.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/globalvalues.h"
 #include "terminallauncher.h"
 #include <QCheckBox>
 #include <QDir>
+#include <QFile>
 #include <QHBoxLayout>
+#include <QImageWriter>
 #include <QKeyEvent>
 #include <QLineEdit>
 #include <QList>
 #include <QListView>
 #include <QListWidgetItem>
 #include <QMessageBox>
+#include <QMimeDatabase>
 #include <QPixmap>
 #include <QProcess>
 #include <QRegularExpression>
+#include <QSet>
 #include <QStandardPaths>
 #include <QTabWidget>
 
@@ -26,7 +32,6 @@ namespace {
 #if defined(Q_OS_WIN)
 QMap<QString, QString> catIconNames({ { "Graphics", "image.svg" },
                                       { "Utility", "apps.svg" } });
-}
 #else
 QMap<QString, QString> catIconNames(
   { { "Multimedia", "applications-multimedia" },
@@ -38,17 +43,57 @@ QMap<QString, QString> catIconNames(
     { "Settings", "preferences-desktop" },
     { "System", "preferences-system" },
     { "Utility", "applications-utilities" } });
-}
 #endif
 
+// Usually on a tmpfs, the capture never goes to disk. Only the user can read
+// the directory.
+QString handoffDirectory()
+{
+    QString directory =
+      QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (directory.isEmpty()) {
+        directory = QDir::tempPath();
+    }
+    directory += QStringLiteral("/flameshot");
+    QDir().mkpath(directory);
+    QFile::setPermissions(directory,
+                          QFile::ReadOwner | QFile::WriteOwner |
+                            QFile::ExeOwner);
+    return directory;
+}
+
+bool writeHandoffFile(const QImage& image,
+                      const QString& path,
+                      const QByteArray& format,
+                      int quality)
+{
+    QImageWriter writer(path, format);
+    writer.setQuality(quality);
+    return writer.write(image);
+}
+
+} // unnamed namespace
+
 AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
   : QWidget(parent)
-  , m_pixmap(p)
+  , m_image(p.toImage())
 {
     setAttribute(Qt::WA_DeleteOnClose);
     setWindowIcon(QIcon(GlobalValues::iconPath()));
     setWindowTitle(tr("Open With"));
 
+    // The capture is written while an application is picked. Most of them
+    // open PNG, which zlib level 1, quality 80 for Qt, writes several times
+    // faster than the default level for a file that is only read once.
+    QString pngFile =
+      FileNameHandler().properScreenshotPath(handoffDirectory(), "png");
+    m_encoder.setMaxThreadCount(1);
+    m_encoder.start([this, pngFile]() {
+        if (writeHandoffFile(m_image, pngFile, "png", 80)) {
+            m_backgroundFile = pngFile;
+        }
+    });
+
     m_keepOpen = ConfigHandler().keepOpenAppLauncher();
 
 #if defined(Q_OS_WIN)
@@ -63,14 +108,7 @@ AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
         m_parser.processDirectory(allUserAppsFolder);
     }
 #else
-    QStringList appsLocations =
-      QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
-
-    for (const auto& appsLocation : appsLocations) {
-        QDir appsDir(appsLocation);
-        m_parser.processDirectory(QDir(appsDir));
-    }
-
+    m_parser.setApps(DesktopEntryIndex::instance()->entries());
 #endif
 
     initAppMap();
@@ -90,11 +128,7 @@ AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
             &QLineEdit::textChanged,
             this,
             &AppLauncherWidget::searchChanged);
-    m_filterList = new QListWidget;
-    m_filterList->hide();
-    configureListView(m_filterList);
-    connect(
-      m_filterList, &QListWidget::clicked, this, &AppLauncherWidget::launch);
+    initSearch();
 
     m_layout = new QVBoxLayout(this);
     m_layout->addWidget(m_filterList);
@@ -105,18 +139,31 @@ AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
     m_lineEdit->setFocus();
 }
 
-void AppLauncherWidget::launch(const QModelIndex& index)
+AppLauncherWidget::~AppLauncherWidget()
 {
-    if (!QFileInfo(m_tempFile).isReadable()) {
-        m_tempFile =
-          FileNameHandler().properScreenshotPath(QDir::tempPath(), "png");
-        bool ok = m_pixmap.save(m_tempFile);
-        if (!ok) {
-            QMessageBox::about(
-              this, tr("Error"), tr("Unable to write in") + QDir::tempPath());
-            return;
+    m_encoder.waitForDone();
+    // The applications may still be reading the files they were given, the
+    // others are only in the way, and in memory on a tmpfs
+    if (!m_backgroundFile.isEmpty()) {
+        QFile::remove(m_backgroundFile);
+    }
+    for (const QString& file : std::as_const(m_handoffFiles)) {
+        if (!m_launchedFiles.contains(file)) {
+            QFile::remove(file);
         }
     }
+}
+
+void AppLauncherWidget::launch(const QModelIndex& index)
+{
+    m_tempFile = handoffFile(
+      index.data(LauncherItemDelegate::MimeTypesRole).toStringList());
+    if (m_tempFile.isEmpty()) {
+        QMessageBox::about(
+          this, tr("Error"), tr("Unable to write in") + handoffDirectory());
+        return;
+    }
+    m_launchedFiles.insert(m_tempFile);
     // Heuristically, if there is a % in the command we assume it is the file
     // name slot
     QString command = index.data(Qt::UserRole).toString();
@@ -175,27 +222,8 @@ void AppLauncherWidget::searchChanged(const QString& text)
     } else {
         m_tabWidget->hide();
         m_filterList->show();
-        m_filterList->clear();
-        const QRegularExpression regexp(
-          QRegularExpression::wildcardToRegularExpression("*" + text + "*"),
-          QRegularExpression::CaseInsensitiveOption);
-        QVector<DesktopAppData> apps;
-
-        for (auto const& i : catIconNames.toStdMap()) {
-            const QString& cat = i.first;
-            if (!m_appsMap.contains(cat)) {
-                continue;
-            }
-            const QVector<DesktopAppData>& appList = m_appsMap[cat];
-            for (const DesktopAppData& app : appList) {
-                if (!apps.contains(app) && (app.name.contains(regexp) ||
-                                            app.description.contains(regexp))) {
-                    apps.append(app);
-                }
-            }
-        }
-        addAppsToListWidget(m_filterList, apps);
     }
+    m_searchModel->setQuery(text);
 }
 
 void AppLauncherWidget::initListWidget()
@@ -274,16 +302,88 @@ void AppLauncherWidget::initAppMap()
     }
 }
 
-void AppLauncherWidget::configureListView(QListWidget* widget)
+/**
+ * @brief The capture written in a format the application opens: PNG when it
+ * opens PNG or doesn't tell, else the first of its types Qt can write.
+ */
+QString AppLauncherWidget::handoffFile(const QStringList& mimeTypes)
+{
+    m_encoder.waitForDone();
+    if (!m_backgroundFile.isEmpty()) {
+        m_handoffFiles.insert(QStringLiteral("image/png"), m_backgroundFile);
+        m_backgroundFile.clear();
+    }
+
+    QString mimeType = QStringLiteral("image/png");
+    if (!mimeTypes.isEmpty() && !mimeTypes.contains(mimeType)) {
+        const QList<QByteArray> writable = QImageWriter::supportedMimeTypes();
+        for (const QString& type : mimeTypes) {
+            if (writable.contains(type.toLatin1())) {
+                mimeType = type;
+                break;
+            }
+        }
+    }
+    QString file = m_handoffFiles.value(mimeType);
+    if (!file.isEmpty() && QFileInfo(file).isReadable()) {
+        return file;
+    }
+
+    // Not written in the background, or removed since
+    const QList<QByteArray> formats =
+      QImageWriter::imageFormatsForMimeType(mimeType.toLatin1());
+    if (formats.isEmpty()) {
+        return {};
+    }
+    QString suffix =
+      QMimeDatabase().mimeTypeForName(mimeType).preferredSuffix();
+    file = FileNameHandler().properScreenshotPath(handoffDirectory(), suffix);
+    int quality =
+      formats.first() == "jpeg" ? ConfigHandler().jpegQuality() : 80;
+    if (!writeHandoffFile(m_image, file, formats.first(), quality)) {
+        return {};
+    }
+    m_handoffFiles.insert(mimeType, file);
+    return file;
+}
+
+// The applications of all the tabs, each once, searched as they are typed
+void AppLauncherWidget::initSearch()
+{
+    QVector<DesktopAppData> apps;
+    QSet<QString> names;
+    for (auto const& i : catIconNames.toStdMap()) {
+        const QString& cat = i.first;
+        if (!m_appsMap.contains(cat)) {
+            continue;
+        }
+        for (const DesktopAppData& app : std::as_const(m_appsMap[cat])) {
+            if (!names.contains(app.name)) {
+                names.insert(app.name);
+                apps.append(app);
+            }
+        }
+    }
+
+    m_searchModel = new LauncherSearchModel(this);
+    m_searchModel->setApps(apps);
+    m_filterList = new QListView;
+    m_filterList->setModel(m_searchModel);
+    m_filterList->setUniformItemSizes(true);
+    m_filterList->hide();
+    configureListView(m_filterList);
+}
+
+void AppLauncherWidget::configureListView(QListView* widget)
 {
     widget->setItemDelegate(new LauncherItemDelegate());
-    widget->setViewMode(QListWidget::IconMode);
+    widget->setViewMode(QListView::IconMode);
     widget->setResizeMode(QListView::Adjust);
     widget->setSpacing(4);
     widget->setFlow(QListView::LeftToRight);
     widget->setDragEnabled(false);
     widget->setMinimumWidth(GlobalValues::buttonBaseSize() * 11);
-    connect(widget, &QListWidget::clicked, this, &AppLauncherWidget::launch);
+    connect(widget, &QListView::clicked, this, &AppLauncherWidget::launch);
 }
 
 void AppLauncherWidget::addAppsToListWidget(
@@ -292,15 +392,21 @@ void AppLauncherWidget::addAppsToListWidget(
 {
     for (const DesktopAppData& app : appList) {
         auto* buttonItem = new QListWidgetItem(widget);
-        buttonItem->setData(Qt::DecorationRole, app.icon);
+        if (app.icon.isNull()) {
+            buttonItem->setData(LauncherItemDelegate::IconNameRole,
+                                app.iconName);
+        } else {
+            buttonItem->setIcon(app.icon);
+        }
         buttonItem->setData(Qt::DisplayRole, app.name);
         buttonItem->setData(Qt::UserRole, app.exec);
         buttonItem->setData(Qt::UserRole + 1, app.showInTerminal);
+        buttonItem->setData(LauncherItemDelegate::MimeTypesRole,
+                            app.mimeTypes);
         QColor foregroundColor =
           this->palette().color(QWidget::foregroundRole());
         buttonItem->setForeground(foregroundColor);
 
-        buttonItem->setIcon(app.icon);
         buttonItem->setText(app.name);
         buttonItem->setToolTip(app.description);
     }
@@ -311,16 +417,16 @@ void AppLauncherWidget::keyPressEvent(QKeyEvent* keyEvent)
     if (keyEvent->key() == Qt::Key_Escape) {
         close();
     } else if (keyEvent->key() == Qt::Key_Return) {
-        auto* widget = (QListWidget*)m_tabWidget->currentWidget();
+        auto* widget = (QListView*)m_tabWidget->currentWidget();
         if (m_filterList->isVisible())
             widget = m_filterList;
-        auto* item = widget->currentItem();
-        if (item == nullptr) {
-            item = widget->item(0);
-            widget->setCurrentItem(item);
+        if (!widget->currentIndex().isValid()) {
+            widget->setCurrentIndex(widget->model()->index(0, 0));
         }
         QModelIndex const idx = widget->currentIndex();
-        AppLauncherWidget::launch(idx);
+        if (idx.isValid()) {
+            AppLauncherWidget::launch(idx);
+        }
     } else {
         QWidget::keyPressEvent(keyEvent);
     }
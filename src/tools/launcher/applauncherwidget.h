@@ -3,7 +3,11 @@
 
 #pragma once
 
+#include <QHash>
+#include <QImage>
 #include <QMap>
+#include <QSet>
+#include <QThreadPool>
 #include <QWidget>
 
 #if defined(Q_OS_WIN)
@@ -16,13 +20,16 @@ class QTabWidget;
 class QCheckBox;
 class QVBoxLayout;
 class QLineEdit;
+class QListView;
 class QListWidget;
+class LauncherSearchModel;
 
 class AppLauncherWidget : public QWidget
 {
     Q_OBJECT
 public:
     explicit AppLauncherWidget(const QPixmap& p, QWidget* parent = nullptr);
+    ~AppLauncherWidget();
 
 private slots:
     void launch(const QModelIndex& index);
@@ -32,7 +39,9 @@ private slots:
 private:
     void initListWidget();
     void initAppMap();
-    void configureListView(QListWidget* widget);
+    void initSearch();
+    QString handoffFile(const QStringList& mimeTypes);
+    void configureListView(QListView* widget);
     void addAppsToListWidget(QListWidget* widget,
                              const QVector<DesktopAppData>& appList);
     void keyPressEvent(QKeyEvent* keyEvent) override;
@@ -42,14 +51,22 @@ private:
 #else
     DesktopFileParser m_parser;
 #endif
-    QPixmap m_pixmap;
+    QImage m_image;
     QString m_tempFile;
+    // The capture written for the applications, by MIME type
+    QHash<QString, QString> m_handoffFiles;
+    // Given to an application, kept when the launcher closes
+    QSet<QString> m_launchedFiles;
+    // Written from m_encoder, read once it is done
+    QString m_backgroundFile;
+    QThreadPool m_encoder;
     bool m_keepOpen;
     QMap<QString, QVector<DesktopAppData>> m_appsMap;
     QCheckBox* m_keepOpenCheckbox;
     QCheckBox* m_terminalCheckbox;
     QVBoxLayout* m_layout;
     QLineEdit* m_lineEdit;
-    QListWidget* m_filterList;
+    QListView* m_filterList;
+    LauncherSearchModel* m_searchModel;
     QTabWidget* m_tabWidget;
 };
@@ -3,8 +3,31 @@
 
 #include "launcheritemdelegate.h"
 #include "src/utils/globalvalues.h"
+#include <QFileInfo>
+#include <QHash>
 #include <QPainter>
 
+namespace {
+
+// Looked up the first time an item with the icon is painted, which is only
+// done for the visible ones
+QIcon themeIcon(const QString& name)
+{
+    static QHash<QString, QIcon> icons;
+    auto it = icons.constFind(name);
+    if (it == icons.constEnd()) {
+        static const QIcon fallback =
+          QIcon::fromTheme(QStringLiteral("application-x-executable"));
+        QIcon icon = QFileInfo(name).isAbsolute()
+                       ? QIcon(name)
+                       : QIcon::fromTheme(name, fallback);
+        it = icons.insert(name, icon);
+    }
+    return *it;
+}
+
+} // unnamed namespace
+
 LauncherItemDelegate::LauncherItemDelegate(QObject* parent)
   : QStyledItemDelegate(parent)
 {}
@@ -23,6 +46,9 @@ void LauncherItemDelegate::paint(QPainter* painter,
         painter->restore();
     }
     auto icon = index.data(Qt::DecorationRole).value<QIcon>();
+    if (icon.isNull()) {
+        icon = themeIcon(index.data(IconNameRole).toString());
+    }
 
     const int iconSide = static_cast<int>(GlobalValues::buttonBaseSize() * 1.3);
     const int halfIcon = iconSide / 2;
@@ -10,6 +10,11 @@ class LauncherItemDelegate : public QStyledItemDelegate
 {
     Q_OBJECT
 public:
+    // Name of the theme icon of the items without a decoration
+    static const int IconNameRole = Qt::UserRole + 2;
+    // MIME types the application of the item opens
+    static const int MimeTypesRole = Qt::UserRole + 3;
+
     explicit LauncherItemDelegate(QObject* parent = nullptr);
 
     void paint(QPainter* painter,
@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "launchersearchmodel.h"
+#include "launcheritemdelegate.h"
+#include <QFileInfo>
+#include <algorithm>
+#include <numeric>
+
+// Weights of the fields, the name counts most
+#define SEARCH_NAME_WEIGHT 4
+#define SEARCH_PROGRAM_WEIGHT 2
+#define SEARCH_DESCRIPTION_WEIGHT 1
+
+// Score of each matched character, and the bonuses added to it
+#define SEARCH_MATCH_SCORE 1
+#define SEARCH_CONSECUTIVE_BONUS 4
+#define SEARCH_WORD_START_BONUS 8
+
+namespace {
+
+bool isWordStart(const QString& text, int i)
+{
+    return i == 0 || !text.at(i - 1).isLetterOrNumber();
+}
+
+/**
+ * @brief Score of `query` as a subsequence of `text`, 0 if it isn't one.
+ *
+ * With `wordStarts`, a character that doesn't carry on the previous match is
+ * taken at the next word starting with it, which can leave none of the
+ * characters after it for the rest of the query.
+ */
+int subsequenceScore(const QString& text, const QString& query, bool wordStarts)
+{
+    int total = 0;
+    int previous = -2;
+    int pos = 0;
+    for (const QChar c : query) {
+        int found = -1;
+        if (pos < text.size() && text.at(pos) == c && previous == pos - 1) {
+            found = pos;
+        } else if (wordStarts) {
+            for (int i = pos; i < text.size(); ++i) {
+                if (text.at(i) == c && isWordStart(text, i)) {
+                    found = i;
+                    break;
+                }
+            }
+        }
+        if (found < 0) {
+            found = text.indexOf(c, pos);
+        }
+        if (found < 0) {
+            return 0;
+        }
+        total += SEARCH_MATCH_SCORE;
+        if (found == previous + 1) {
+            total += SEARCH_CONSECUTIVE_BONUS;
+        }
+        if (isWordStart(text, found)) {
+            total += SEARCH_WORD_START_BONUS;
+        }
+        previous = found;
+        pos = found + 1;
+    }
+    return total;
+}
+
+} // unnamed namespace
+
+LauncherSearchModel::LauncherSearchModel(QObject* parent)
+  : QAbstractListModel(parent)
+{}
+
+int LauncherSearchModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+// The roles of the launcher list items
+QVariant LauncherSearchModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return {};
+    }
+    const DesktopAppData& app = m_entries.at(m_rows.at(index.row())).app;
+    switch (role) {
+        case Qt::DisplayRole:
+            return app.name;
+        case Qt::DecorationRole:
+            return app.icon.isNull() ? QVariant() : QVariant(app.icon);
+        case Qt::ToolTipRole:
+            return app.description;
+        case Qt::UserRole:
+            return app.exec;
+        case Qt::UserRole + 1:
+            return app.showInTerminal;
+        case LauncherItemDelegate::IconNameRole:
+            return app.iconName;
+        case LauncherItemDelegate::MimeTypesRole:
+            return app.mimeTypes;
+        default:
+            return {};
+    }
+}
+
+void LauncherSearchModel::setApps(const QVector<DesktopAppData>& apps)
+{
+    beginResetModel();
+    m_entries.clear();
+    m_entries.reserve(apps.size());
+    for (const DesktopAppData& app : apps) {
+        Entry entry;
+        entry.app = app;
+        entry.name = normalized(app.name);
+        // The program, without its path and arguments
+        entry.program =
+          normalized(QFileInfo(app.exec.section(' ', 0, 0)).fileName());
+        entry.description = normalized(app.description);
+        m_entries.append(entry);
+    }
+    m_query.clear();
+    m_matches.clear();
+    m_rows.clear();
+    endResetModel();
+}
+
+void LauncherSearchModel::setQuery(const QString& query)
+{
+    const QString normalizedQuery = normalized(query).simplified();
+    if (normalizedQuery == m_query) {
+        return;
+    }
+
+    // What matches the query matches any of its prefixes
+    QVector<int> candidates;
+    if (!m_query.isEmpty() && normalizedQuery.startsWith(m_query)) {
+        candidates = m_matches;
+    } else {
+        candidates.resize(m_entries.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+    m_query = normalizedQuery;
+
+    QVector<QPair<int, int>> scored;
+    m_matches.clear();
+    if (!m_query.isEmpty()) {
+        for (int i : std::as_const(candidates)) {
+            const int entryScore = score(m_entries.at(i), m_query);
+            if (entryScore > 0) {
+                scored.append({ entryScore, i });
+                m_matches.append(i);
+            }
+        }
+    }
+    // Best first, then in the order of the applications
+    std::sort(scored.begin(),
+              scored.end(),
+              [](const QPair<int, int>& a, const QPair<int, int>& b) {
+                  return a.first != b.first ? a.first > b.first
+                                            : a.second < b.second;
+              });
+
+    QVector<int> rows;
+    rows.reserve(scored.size());
+    for (const auto& match : std::as_const(scored)) {
+        rows.append(match.second);
+    }
+    setRows(rows);
+}
+
+/**
+ * @brief Lower-case `text` without its accents, to match it whatever way it
+ * was typed.
+ */
+QString LauncherSearchModel::normalized(const QString& text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString result;
+    result.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        if (c.category() != QChar::Mark_NonSpacing) {
+            result.append(c.toLower());
+        }
+    }
+    return result;
+}
+
+// Score of `query` as a subsequence of `text`, 0 if it isn't one. The
+// characters are matched at word starts when they can be, and at their
+// earliest occurrences otherwise.
+int LauncherSearchModel::score(const QString& text, const QString& query)
+{
+    if (query.size() > text.size()) {
+        return 0;
+    }
+    const int atWordStarts = subsequenceScore(text, query, true);
+    return atWordStarts > 0 ? atWordStarts
+                            : subsequenceScore(text, query, false);
+}
+
+int LauncherSearchModel::score(const Entry& entry, const QString& query) const
+{
+    return qMax(
+      qMax(score(entry.name, query) * SEARCH_NAME_WEIGHT,
+           score(entry.program, query) * SEARCH_PROGRAM_WEIGHT),
+      score(entry.description, query) * SEARCH_DESCRIPTION_WEIGHT);
+}
+
+// Turn the current rows into `rows` with as few changes as the views see
+void LauncherSearchModel::setRows(const QVector<int>& rows)
+{
+    // The rows that are gone, back to front so that the indexes hold
+    QVector<bool> kept(m_entries.size(), false);
+    for (int entry : rows) {
+        kept[entry] = true;
+    }
+    for (int row = m_rows.size() - 1; row >= 0;) {
+        if (kept.at(m_rows.at(row))) {
+            --row;
+            continue;
+        }
+        int last = row;
+        while (row > 0 && !kept.at(m_rows.at(row - 1))) {
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        m_rows.remove(row, last - row + 1);
+        endRemoveRows();
+        --row;
+    }
+
+    // What is left is in the new rows, put in their order at once
+    QVector<bool> shown(m_entries.size(), false);
+    for (int entry : std::as_const(m_rows)) {
+        shown[entry] = true;
+    }
+    QVector<int> order;
+    order.reserve(m_rows.size());
+    for (int entry : rows) {
+        if (shown.at(entry)) {
+            order.append(entry);
+        }
+    }
+    if (order != m_rows) {
+        emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+        QVector<int> position(m_entries.size(), -1);
+        for (int row = 0; row < order.size(); ++row) {
+            position[order.at(row)] = row;
+        }
+        const QModelIndexList before = persistentIndexList();
+        QModelIndexList after;
+        after.reserve(before.size());
+        for (const QModelIndex& index : before) {
+            after.append(this->index(position.at(m_rows.at(index.row()))));
+        }
+        m_rows = order;
+        changePersistentIndexList(before, after);
+        emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+
+    // And the rows that are new, a run at a time
+    for (int row = 0; row < rows.size();) {
+        if (row < m_rows.size() && m_rows.at(row) == rows.at(row)) {
+            ++row;
+            continue;
+        }
+        int last = row;
+        while (last + 1 < rows.size() && !shown.at(rows.at(last + 1))) {
+            ++last;
+        }
+        beginInsertRows(QModelIndex(), row, last);
+        m_rows.insert(row, last - row + 1, 0);
+        std::copy(
+          rows.begin() + row, rows.begin() + last + 1, m_rows.begin() + row);
+        endInsertRows();
+        row = last + 1;
+    }
+}
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/desktopfileparse.h"
+#include <QAbstractListModel>
+#include <QVector>
+
+/**
+ * @brief List model of the applications matching the launcher search.
+ *
+ * The names, programs and descriptions are lower-cased and stripped of their
+ * accents once, when the applications are set. A query matches the
+ * applications where its characters appear in order, scored higher for
+ * consecutive characters, for characters at the start of words and in the
+ * name. As the query grows only the applications that matched the shorter
+ * one are searched again. `setQuery` only emits the removals, a single
+ * layout change when the rows left are reordered, and the insertions between
+ * the previous and the new rows, best match first.
+ */
+class LauncherSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit LauncherSearchModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+
+    void setApps(const QVector<DesktopAppData>& apps);
+    void setQuery(const QString& query);
+
+    static QString normalized(const QString& text);
+
+private:
+    struct Entry
+    {
+        DesktopAppData app;
+        QString name;
+        QString program;
+        QString description;
+    };
+
+    static int score(const QString& text, const QString& query);
+    int score(const Entry& entry, const QString& query) const;
+    void setRows(const QVector<int>& rows);
+
+    QVector<Entry> m_entries;
+    QString m_query;
+    // Entries matching m_query, in no particular order
+    QVector<int> m_matches;
+    // Entries shown, best match first
+    QVector<int> m_rows;
+};
@@ -35,6 +35,12 @@ void TextTool::copyParams(const TextTool* from, TextTool* to)
     to->m_color = from->m_color;
     to->m_textArea = from->m_textArea;
     to->m_currentPos = from->m_currentPos;
+    to->m_lines = from->m_lines;
+    to->m_layoutSize = from->m_layoutSize;
+    to->m_lineSpacing = from->m_lineSpacing;
+    to->m_layoutText = from->m_layoutText;
+    to->m_layoutFont = from->m_layoutFont;
+    to->m_layoutDpr = from->m_layoutDpr;
 }
 
 bool TextTool::isValid() const
@@ -200,28 +206,60 @@ void TextTool::process(QPainter& painter, const QPixmap& pixmap)
         return;
     }
     const int val = 5;
-    QFont orig_font = painter.font();
-    QPen orig_pen = painter.pen();
-    QFontMetrics fm(m_font);
-    QSize fontsize(fm.boundingRect(QRect(), 0, m_text).size());
-    fontsize.setWidth(fontsize.width() + val * 2);
-    fontsize.setHeight(fontsize.height() + val * 2);
-    m_textArea.setSize(fontsize);
+    updateLayout(painter);
+    m_textArea.setSize(m_layoutSize + QSize(val * 2, val * 2));
     // draw text
-    painter.setFont(m_font);
-    painter.setPen(m_color);
     if (!editMode()) {
-        painter.drawText(
-          m_textArea + QMargins(-val, -val, val, val), m_alignment, m_text);
+        QFont orig_font = painter.font();
+        QPen orig_pen = painter.pen();
+        painter.setFont(m_font);
+        painter.setPen(m_color);
+        QPoint linePos = m_textArea.topLeft() + QPoint(val, val);
+        for (const auto& line : m_lines) {
+            int x = linePos.x();
+            const int freeSpace =
+              m_layoutSize.width() - qRound(line.size().width());
+            if (m_alignment & Qt::AlignRight) {
+                x += freeSpace;
+            } else if (m_alignment & Qt::AlignHCenter) {
+                x += freeSpace / 2;
+            }
+            painter.drawStaticText(x, linePos.y(), line);
+            linePos.ry() += m_lineSpacing;
+        }
+        painter.setFont(orig_font);
+        painter.setPen(orig_pen);
     }
-    painter.setFont(orig_font);
-    painter.setPen(orig_pen);
 
     if (m_widget != nullptr) {
         m_widget->setAlignment(m_alignment);
     }
 }
 
+void TextTool::updateLayout(const QPainter& painter)
+{
+    const qreal dpr = painter.device()->devicePixelRatio();
+    if (m_text == m_layoutText && m_font == m_layoutFont &&
+        dpr == m_layoutDpr) {
+        return;
+    }
+
+    QFontMetrics fm(m_font);
+    m_layoutSize = fm.boundingRect(QRect(), 0, m_text).size();
+    m_lineSpacing = fm.lineSpacing();
+    m_lines.clear();
+    for (const QString& text : m_text.split('\n')) {
+        QStaticText line(text);
+        line.setTextFormat(Qt::PlainText);
+        line.prepare(painter.transform(), m_font);
+        m_lines.append(line);
+    }
+
+    m_layoutText = m_text;
+    m_layoutFont = m_font;
+    m_layoutDpr = dpr;
+}
+
 void TextTool::drawObjectSelection(QPainter& painter)
 {
     if (m_text.isEmpty()) {
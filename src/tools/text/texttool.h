@@ -7,6 +7,7 @@
 #include "textconfig.h"
 #include <QPoint>
 #include <QPointer>
+#include <QStaticText>
 class TextWidget;
 class TextConfig;
 
@@ -67,6 +68,7 @@ private slots:
 
 private:
     void closeEditor();
+    void updateLayout(const QPainter& painter);
 
     QFont m_font;
     Qt::AlignmentFlag m_alignment;
@@ -80,4 +82,13 @@ private:
     QPoint m_currentPos;
 
     QString m_tempString;
+
+    // Shaped lines of m_text, rebuilt only when the text, the font or the
+    // device pixel ratio change
+    QVector<QStaticText> m_lines;
+    QSize m_layoutSize;
+    int m_lineSpacing{ 0 };
+    QString m_layoutText;
+    QFont m_layoutFont;
+    qreal m_layoutDpr{ 0 };
 };
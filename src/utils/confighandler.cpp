@@ -81,6 +81,7 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     OPTION("disabledTrayIcon"            ,Bool               ( false         )),
     OPTION("useGrimAdapter"              ,Bool               ( false         )),
     OPTION("disabledGrimWarning"         ,Bool               ( false         )),
+    OPTION("grabScreensSeparately"       ,Bool               ( false         )),
     OPTION("historyConfirmationToDelete" ,Bool               ( true          )),
 #if !defined(DISABLE_UPDATE_CHECKER)
     OPTION("checkForUpdates"             ,Bool               ( true          )),
@@ -104,6 +105,7 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     OPTION("savePathFixed"               ,Bool               ( false         )),
     OPTION("saveAsFileExtension"         ,SaveFileExtension  (               )),
     OPTION("saveLastRegion"              ,Bool               ( false         )),
+    OPTION("linkDuplicateSaves"          ,Bool               ( false         )),
     OPTION("uploadHistoryMax"            ,LowerBoundedInt    ( 0, 25         )),
     OPTION("undoLimit"                   ,BoundedInt         ( 0, 999, 100   )),
     // Interface tab
@@ -132,6 +134,18 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     // drawFontSize, remember to update ConfigHandler::toolSize
     OPTION("copyOnDoubleClick"           ,Bool               ( false         )),
     OPTION("uploadClientSecret"          ,String             ( "313baf0c7b4d3ff" )),
+    // Storage the uploads go to, "imgur" or "http"
+    OPTION("uploadStorage"               ,String             ( "imgur"       )),
+    OPTION("uploadHttpUrl"               ,String             ( ""            )),
+    OPTION("uploadHttpField"             ,String             ( "image"       )),
+    OPTION("uploadHttpAuthorization"     ,String             ( ""            )),
+    OPTION("uploadHttpLink"              ,String             ( ""            )),
+    OPTION("uploadHttpDeleteUrl"         ,String             ( ""            )),
+    // Budgets of the uploaded images, 0 for none, and the SSIM in percent the
+    // images re-encoded to fit must keep
+    OPTION("uploadMaxBytes"              ,LowerBoundedInt    ( 0, 0          )),
+    OPTION("uploadMaxPixels"             ,LowerBoundedInt    ( 0, 0          )),
+    OPTION("uploadMinQuality"            ,BoundedInt         ( 0, 100, 95    )),
     OPTION("showSelectionGeometry"       , BoundedInt        ( 0, 5, 4       )),
     OPTION("showSelectionGeometryHideTime", LowerBoundedInt  ( 0, 3000       )),
     OPTION("jpegQuality"                 , BoundedInt        ( 0,100,75      )),
@@ -91,6 +91,7 @@ public:
     CONFIG_GETTER_SETTER(disabledTrayIcon, setDisabledTrayIcon, bool)
     CONFIG_GETTER_SETTER(useGrimAdapter, useGrimAdapter, bool)
     CONFIG_GETTER_SETTER(disabledGrimWarning, disabledGrimWarning, bool)
+    CONFIG_GETTER_SETTER(grabScreensSeparately, setGrabScreensSeparately, bool)
     CONFIG_GETTER_SETTER(drawThickness, setDrawThickness, int)
     CONFIG_GETTER_SETTER(drawFontSize, setDrawFontSize, int)
     CONFIG_GETTER_SETTER(drawCircleCounterSize, setDrawCircleCounterSize, int)
@@ -132,7 +133,19 @@ public:
     CONFIG_GETTER_SETTER(squareMagnifier, setSquareMagnifier, bool)
     CONFIG_GETTER_SETTER(copyOnDoubleClick, setCopyOnDoubleClick, bool)
     CONFIG_GETTER_SETTER(uploadClientSecret, setUploadClientSecret, QString)
+    CONFIG_GETTER_SETTER(uploadStorage, setUploadStorage, QString)
+    CONFIG_GETTER_SETTER(uploadHttpUrl, setUploadHttpUrl, QString)
+    CONFIG_GETTER_SETTER(uploadHttpField, setUploadHttpField, QString)
+    CONFIG_GETTER_SETTER(uploadHttpAuthorization,
+                         setUploadHttpAuthorization,
+                         QString)
+    CONFIG_GETTER_SETTER(uploadHttpLink, setUploadHttpLink, QString)
+    CONFIG_GETTER_SETTER(uploadHttpDeleteUrl, setUploadHttpDeleteUrl, QString)
+    CONFIG_GETTER_SETTER(uploadMaxBytes, setUploadMaxBytes, int)
+    CONFIG_GETTER_SETTER(uploadMaxPixels, setUploadMaxPixels, int)
+    CONFIG_GETTER_SETTER(uploadMinQuality, setUploadMinQuality, int)
     CONFIG_GETTER_SETTER(saveLastRegion, setSaveLastRegion, bool)
+    CONFIG_GETTER_SETTER(linkDuplicateSaves, setLinkDuplicateSaves, bool)
     CONFIG_GETTER_SETTER(showSelectionGeometry, setShowSelectionGeometry, int)
     CONFIG_GETTER_SETTER(jpegQuality, setJpegQuality, int)
     CONFIG_GETTER_SETTER(reverseArrow, setReverseArrow, bool)
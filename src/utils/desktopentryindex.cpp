@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "desktopentryindex.h"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QLocale>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#define DESKTOP_INDEX_FILE "desktop-entries.cache"
+#define DESKTOP_INDEX_MAGIC 0x46534445
+#define DESKTOP_INDEX_VERSION 2
+// Files parsed by each task when the entries are parsed again
+#define DESKTOP_INDEX_BATCH 32
+// Delay before the entries are parsed again once a directory changed, in ms
+#define DESKTOP_INDEX_REFRESH_DELAY 1000
+
+namespace {
+
+void writeApp(QDataStream& out, const DesktopAppData& app)
+{
+    out << app.name << app.description << app.exec << app.categories
+        << app.iconName << app.showInTerminal << app.mimeTypes;
+}
+
+void readApp(QDataStream& in, DesktopAppData& app)
+{
+    in >> app.name >> app.description >> app.exec >> app.categories >>
+      app.iconName >> app.showInTerminal >> app.mimeTypes;
+}
+
+} // unnamed namespace
+
+DesktopEntryIndex::DesktopEntryIndex(QObject* parent)
+  : QObject(parent)
+  , m_cachePath(
+      QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+      "/flameshot/" DESKTOP_INDEX_FILE)
+{
+    m_refresher.setMaxThreadCount(1);
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(DESKTOP_INDEX_REFRESH_DELAY);
+    connect(
+      &m_refreshTimer, &QTimer::timeout, this, &DesktopEntryIndex::refresh);
+}
+
+DesktopEntryIndex::~DesktopEntryIndex()
+{
+    m_refresher.waitForDone();
+}
+
+DesktopEntryIndex* DesktopEntryIndex::instance()
+{
+    static DesktopEntryIndex* index =
+      new DesktopEntryIndex(QCoreApplication::instance());
+    return index;
+}
+
+/**
+ * @brief The applications, from memory or the cache file when they are up
+ * to date, parsed again otherwise.
+ */
+QVector<DesktopAppData> DesktopEntryIndex::entries()
+{
+    DirectoryTimes times = directoryTimes();
+    if (m_loaded && times == m_times) {
+        return m_entries;
+    }
+    if (!load(m_cachePath, times, m_entries)) {
+        m_entries = parse(times);
+        save(m_cachePath, times, m_entries);
+    }
+    m_times = times;
+    m_loaded = true;
+    return m_entries;
+}
+
+/**
+ * @brief Keep the entries up to date in memory, for the daemon.
+ */
+void DesktopEntryIndex::keepWarm()
+{
+    if (m_watcher != nullptr) {
+        return;
+    }
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher,
+            &QFileSystemWatcher::directoryChanged,
+            &m_refreshTimer,
+            qOverload<>(&QTimer::start));
+    refresh();
+}
+
+DesktopEntryIndex::DirectoryTimes DesktopEntryIndex::directoryTimes()
+{
+    DirectoryTimes times;
+    const QStringList directories =
+      QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
+    for (const QString& directory : directories) {
+        QFileInfo info(directory);
+        // A directory created later makes the entries stale too
+        times.append({ directory,
+                       info.exists() ? info.lastModified().toMSecsSinceEpoch()
+                                     : -1 });
+    }
+    return times;
+}
+
+QVector<DesktopAppData> DesktopEntryIndex::parse(
+  const DirectoryTimes& directories)
+{
+    // Note that
+    // https://specifications.freedesktop.org/desktop-entry-spec/desktop-entry-spec-latest.html
+    // says files must end in .desktop or .directory
+    QStringList files;
+    for (const auto& directory : directories) {
+        QDir dir(directory.first);
+        const QStringList names =
+          dir.entryList({ "*.desktop" }, QDir::NoDotAndDotDot | QDir::Files);
+        for (const QString& name : names) {
+            files.append(dir.absoluteFilePath(name));
+        }
+    }
+
+    const DesktopFileParser parser;
+    QVector<DesktopAppData> apps(files.size());
+    QVector<bool> parsed(files.size(), false);
+    QThreadPool pool;
+    for (int first = 0; first < files.size(); first += DESKTOP_INDEX_BATCH) {
+        pool.start([&, first]() {
+            const int last = qMin(first + DESKTOP_INDEX_BATCH, files.size());
+            for (int i = first; i < last; ++i) {
+                bool ok = false;
+                apps[i] = parser.parseDesktopFile(files[i], ok);
+                parsed[i] = ok;
+            }
+        });
+    }
+    pool.waitForDone();
+
+    // In the order of the directories, like they were parsed one by one
+    QVector<DesktopAppData> entries;
+    for (int i = 0; i < apps.size(); ++i) {
+        if (parsed[i]) {
+            entries.append(apps[i]);
+        }
+    }
+    return entries;
+}
+
+// The entries of the cache file, if it was written for `times` and the
+// current locale
+bool DesktopEntryIndex::load(const QString& cachePath,
+                             const DirectoryTimes& times,
+                             QVector<DesktopAppData>& entries)
+{
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString locale;
+    DirectoryTimes cachedTimes;
+    in >> magic >> version;
+    if (magic != DESKTOP_INDEX_MAGIC || version != DESKTOP_INDEX_VERSION) {
+        return false;
+    }
+    in >> locale >> cachedTimes;
+    if (locale != QLocale().name() || cachedTimes != times) {
+        return false;
+    }
+    qint32 count = 0;
+    in >> count;
+    QVector<DesktopAppData> cached(qMax(0, count));
+    for (DesktopAppData& app : cached) {
+        readApp(in, app);
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    entries = cached;
+    return true;
+}
+
+void DesktopEntryIndex::save(const QString& cachePath,
+                             const DirectoryTimes& times,
+                             const QVector<DesktopAppData>& entries)
+{
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint32(DESKTOP_INDEX_MAGIC) << quint32(DESKTOP_INDEX_VERSION)
+        << QLocale().name() << times << qint32(entries.size());
+    for (const DesktopAppData& app : entries) {
+        writeApp(out, app);
+    }
+    file.commit();
+}
+
+// Bring the entries up to date in the background
+void DesktopEntryIndex::refresh()
+{
+    if (m_refreshing) {
+        // Once the current refresh is done
+        m_refreshTimer.start();
+        return;
+    }
+    m_refreshing = true;
+    DirectoryTimes known = m_loaded ? m_times : DirectoryTimes();
+    QString cachePath = m_cachePath;
+    m_refresher.start([this, known, cachePath]() {
+        DirectoryTimes times = directoryTimes();
+        QVector<DesktopAppData> entries;
+        bool changed = times != known;
+        if (changed && !load(cachePath, times, entries)) {
+            entries = parse(times);
+            save(cachePath, times, entries);
+        }
+        QMetaObject::invokeMethod(this, [this, times, entries, changed]() {
+            m_refreshing = false;
+            if (changed) {
+                m_entries = entries;
+                m_times = times;
+                m_loaded = true;
+            }
+            watchDirectories();
+        });
+    });
+}
+
+void DesktopEntryIndex::watchDirectories()
+{
+    for (const auto& directory : std::as_const(m_times)) {
+        if (directory.second >= 0 &&
+            !m_watcher->directories().contains(directory.first)) {
+            m_watcher->addPath(directory.first);
+        }
+    }
+}
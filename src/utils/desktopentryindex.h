@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/desktopfileparse.h"
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+class QFileSystemWatcher;
+
+/**
+ * @brief The applications of the desktop entries, for the launcher.
+ *
+ * Parsing every desktop entry takes up to a second on systems with thousands
+ * of applications, so the parsed entries are kept in a file in the cache
+ * directory with the modification times of the applications directories they
+ * were read from. Installing or removing an application changes the time of
+ * its directory, which makes the file stale: the entries are then parsed
+ * again, spread over a thread pool. The daemon keeps the entries in memory
+ * and parses them again in the background as soon as a directory changes.
+ */
+class DesktopEntryIndex : public QObject
+{
+    Q_OBJECT
+public:
+    static DesktopEntryIndex* instance();
+    ~DesktopEntryIndex();
+
+    QVector<DesktopAppData> entries();
+    void keepWarm();
+
+private:
+    // Applications directories and their modification times in ms
+    using DirectoryTimes = QList<QPair<QString, qint64>>;
+
+    explicit DesktopEntryIndex(QObject* parent = nullptr);
+
+    static DirectoryTimes directoryTimes();
+    static QVector<DesktopAppData> parse(const DirectoryTimes& directories);
+    static bool load(const QString& cachePath,
+                     const DirectoryTimes& times,
+                     QVector<DesktopAppData>& entries);
+    static void save(const QString& cachePath,
+                     const DirectoryTimes& times,
+                     const QVector<DesktopAppData>& entries);
+    void refresh();
+    void watchDirectories();
+
+    QString m_cachePath;
+    DirectoryTimes m_times;
+    QVector<DesktopAppData> m_entries;
+    bool m_loaded{ false };
+
+    QFileSystemWatcher* m_watcher{ nullptr };
+    // Directories change many times while a package is installed
+    QTimer m_refreshTimer;
+    QThreadPool m_refresher;
+    bool m_refreshing{ false };
+};
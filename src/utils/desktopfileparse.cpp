@@ -16,10 +16,11 @@ DesktopFileParser::DesktopFileParser()
     m_localeDescription = QStringLiteral("Comment[%1]").arg(locale);
     m_localeNameShort = QStringLiteral("Name[%1]").arg(localeShort);
     m_localeDescriptionShort = QStringLiteral("Comment[%1]").arg(localeShort);
-    m_defaultIcon =
-      QIcon::fromTheme(QStringLiteral("application-x-executable"));
 }
 
+/**
+ * @brief Parse a desktop entry. Safe to call from several threads at once.
+ */
 DesktopAppData DesktopFileParser::parseDesktopFile(const QString& fileName,
                                                    bool& ok) const
 {
@@ -42,9 +43,10 @@ DesktopAppData DesktopFileParser::parseDesktopFile(const QString& fileName,
     while (!in.atEnd()) {
         QString line = in.readLine();
         if (line.startsWith(QLatin1String("Icon"))) {
-            res.icon = QIcon::fromTheme(
-              line.mid(line.indexOf(QLatin1String("=")) + 1).trimmed(),
-              m_defaultIcon);
+            // Looking the icon up in the theme is slow and only done on the
+            // GUI thread, once it is shown
+            res.iconName =
+              line.mid(line.indexOf(QLatin1String("=")) + 1).trimmed();
         } else if (!nameLocaleSet && line.startsWith(QLatin1String("Name"))) {
             if (line.startsWith(m_localeName) ||
                 line.startsWith(m_localeNameShort)) {
@@ -84,6 +86,9 @@ DesktopAppData DesktopFileParser::parseDesktopFile(const QString& fileName,
         } else if (line.startsWith(QLatin1String("Categories"))) {
             res.categories = line.mid(line.indexOf(QLatin1String("=")) + 1)
                                .split(QStringLiteral(";"));
+        } else if (line.startsWith(QLatin1String("MimeType"))) {
+            res.mimeTypes = line.mid(line.indexOf(QLatin1String("=")) + 1)
+                              .split(QStringLiteral(";"), Qt::SkipEmptyParts);
         } else if (line == QLatin1String("NoDisplay=true")) {
             ok = false;
             break;
@@ -123,6 +128,12 @@ int DesktopFileParser::processDirectory(const QDir& dir)
     return m_appList.length() - length;
 }
 
+// Use apps parsed before, by DesktopEntryIndex
+void DesktopFileParser::setApps(const QVector<DesktopAppData>& apps)
+{
+    m_appList = apps;
+}
+
 QVector<DesktopAppData> DesktopFileParser::getAppsByCategory(
   const QString& category)
 {
@@ -38,6 +38,10 @@ struct DesktopAppData
     QString exec;
     QStringList categories;
     QIcon icon;
+    // Theme icon or path of the desktop entries, resolved when it is shown
+    QString iconName;
+    // Types of the files the application opens
+    QStringList mimeTypes;
     bool showInTerminal;
 };
 
@@ -46,6 +50,7 @@ struct DesktopFileParser
     DesktopFileParser();
     DesktopAppData parseDesktopFile(const QString& fileName, bool& ok) const;
     int processDirectory(const QDir& dir);
+    void setApps(const QVector<DesktopAppData>& apps);
 
     QVector<DesktopAppData> getAppsByCategory(const QString& category);
     QMap<QString, QVector<DesktopAppData>> getAppsByCategory(
@@ -57,6 +62,5 @@ private:
     QString m_localeNameShort;
     QString m_localeDescriptionShort;
 
-    QIcon m_defaultIcon;
     QVector<DesktopAppData> m_appList;
 };
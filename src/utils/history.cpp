@@ -1,22 +1,169 @@
 #include "history.h"
+#include "abstractlogger.h"
 #include "src/utils/confighandler.h"
+#include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QProcessEnvironment>
+#include <QSaveFile>
 #include <QStringList>
+#include <QtEndian>
+#include <algorithm>
+#include <climits>
 
-History::History()
+// Primes of XXH64
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+namespace {
+
+QString historyDirectory()
 {
-    // Get cache history path
-    ConfigHandler config;
 #ifdef Q_OS_WIN
-    m_historyPath = QDir::homePath() + "/AppData/Roaming/flameshot/history/";
+    return QDir::homePath() + "/AppData/Roaming/flameshot/history/";
 #else
     QString cachepath = QProcessEnvironment::systemEnvironment().value(
       "XDG_CACHE_HOME", QDir::homePath() + "/.cache");
-    m_historyPath = cachepath + "/flameshot/history/";
+    return cachepath + "/flameshot/history/";
 #endif
+}
+
+void warnIndexNotUpdated(const QString& indexPath)
+{
+    AbstractLogger::warning(AbstractLogger::Stderr)
+      << QObject::tr("Unable to update the history index %1").arg(indexPath);
+}
+
+// Called from the writer, the signal is emitted on the GUI thread
+void notifyRemoved(const QString& file)
+{
+    HistoryNotifier* notifier = History::notifier();
+    QMetaObject::invokeMethod(
+      notifier, [notifier, file]() { emit notifier->entryRemoved(file); });
+}
+
+// Averages every 2x2 block of pixels of a 32 bit image, two channels at a
+// time in each 32 bit integer so that the compiler can vectorize the loop
+QImage halve(const QImage& image)
+{
+    QImage half(image.width() / 2, image.height() / 2, image.format());
+    for (int y = 0; y < half.height(); ++y) {
+        auto* top =
+          reinterpret_cast<const quint32*>(image.constScanLine(2 * y));
+        auto* bottom =
+          reinterpret_cast<const quint32*>(image.constScanLine(2 * y + 1));
+        auto* out = reinterpret_cast<quint32*>(half.scanLine(y));
+        for (int x = 0; x < half.width(); ++x) {
+            const quint32 a = top[2 * x];
+            const quint32 b = top[2 * x + 1];
+            const quint32 c = bottom[2 * x];
+            const quint32 d = bottom[2 * x + 1];
+            // Each 16 bit lane holds the sum of four 8 bit channels at most
+            const quint32 rb = (a & 0x00ff00ff) + (b & 0x00ff00ff) +
+                               (c & 0x00ff00ff) + (d & 0x00ff00ff) +
+                               0x00020002;
+            const quint32 ag = ((a >> 8) & 0x00ff00ff) +
+                               ((b >> 8) & 0x00ff00ff) +
+                               ((c >> 8) & 0x00ff00ff) +
+                               ((d >> 8) & 0x00ff00ff) + 0x00020002;
+            out[x] = ((rb >> 2) & 0x00ff00ff) | (((ag >> 2) & 0x00ff00ff) << 8);
+        }
+    }
+    return half;
+}
+
+inline quint64 rotl(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline quint64 xxhRound(quint64 acc, quint64 input)
+{
+    return rotl(acc + input * XXH_PRIME64_2, 31) * XXH_PRIME64_1;
+}
+
+inline quint64 xxhMerge(quint64 acc, quint64 value)
+{
+    return (acc ^ xxhRound(0, value)) * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+// XXH64 of `size` bytes. The four independent lanes of the main loop keep
+// the multipliers of the CPU busy, which makes it several times faster than a
+// cryptographic hash on full screenshots.
+quint64 xxh64(const uchar* data, qsizetype size, quint64 seed)
+{
+    const uchar* end = data + size;
+    quint64 hash;
+    if (size >= 32) {
+        quint64 v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        quint64 v2 = seed + XXH_PRIME64_2;
+        quint64 v3 = seed;
+        quint64 v4 = seed - XXH_PRIME64_1;
+        for (; data + 32 <= end; data += 32) {
+            v1 = xxhRound(v1, qFromLittleEndian<quint64>(data));
+            v2 = xxhRound(v2, qFromLittleEndian<quint64>(data + 8));
+            v3 = xxhRound(v3, qFromLittleEndian<quint64>(data + 16));
+            v4 = xxhRound(v4, qFromLittleEndian<quint64>(data + 24));
+        }
+        hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        hash = xxhMerge(hash, v1);
+        hash = xxhMerge(hash, v2);
+        hash = xxhMerge(hash, v3);
+        hash = xxhMerge(hash, v4);
+    } else {
+        hash = seed + XXH_PRIME64_5;
+    }
+    hash += size;
+
+    for (; data + 8 <= end; data += 8) {
+        hash ^= xxhRound(0, qFromLittleEndian<quint64>(data));
+        hash = rotl(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+    if (data + 4 <= end) {
+        hash ^= quint64(qFromLittleEndian<quint32>(data)) * XXH_PRIME64_1;
+        hash = rotl(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        data += 4;
+    }
+    for (; data < end; ++data) {
+        hash ^= *data * XXH_PRIME64_5;
+        hash = rotl(hash, 11) * XXH_PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+} // unnamed namespace
+
+HistoryNotifier::HistoryNotifier(QObject* parent)
+  : QObject(parent)
+{
+    // One writer keeps the changes to the index in order
+    m_writer.setMaxThreadCount(1);
+}
 
+HistoryNotifier::~HistoryNotifier()
+{
+    m_writer.waitForDone();
+}
+
+QThreadPool* HistoryNotifier::writer()
+{
+    return &m_writer;
+}
+
+History::History()
+  : m_historyPath(historyDirectory())
+  , m_index(m_historyPath)
+{
     // Check if directory for history exists and create if doesn't
     QDir dir = QDir(m_historyPath);
     if (!dir.exists()) {
@@ -29,48 +176,257 @@ const QString& History::path()
     return m_historyPath;
 }
 
+/**
+ * @brief Add an uploaded image to the history.
+ *
+ * The thumbnail is made and written, and the entry added, in the background.
+ * HistoryNotifier::entryAdded() is emitted once they are.
+ */
 void History::save(const QPixmap& pixmap, const QString& fileName)
 {
-    // scale preview only in local disk
-    QPixmap pixmapScaled = QPixmap(pixmap);
-    if (pixmap.height() / HISTORYPIXMAP_MAX_PREVIEW_HEIGHT >=
-        pixmap.width() / HISTORYPIXMAP_MAX_PREVIEW_WIDTH) {
-        pixmapScaled = pixmap.scaledToHeight(HISTORYPIXMAP_MAX_PREVIEW_HEIGHT,
-                                             Qt::SmoothTransformation);
-    } else {
-        pixmapScaled = pixmap.scaledToWidth(HISTORYPIXMAP_MAX_PREVIEW_WIDTH,
-                                            Qt::SmoothTransformation);
-    }
+    // Pixmaps can't leave the GUI thread, the image shares their pixels
+    save(pixmap.toImage(), fileName);
+}
 
-    // save preview
-    QFile file(path() + fileName);
-    file.open(QIODevice::WriteOnly);
-    pixmapScaled.save(&file, "PNG");
+void History::save(const QImage& image,
+                   const QString& fileName,
+                   const QString& encoding,
+                   qint64 uploadSize,
+                   const QByteArray& hash)
+{
+    const HistoryFileName& unpacked = unpackFileName(fileName);
+    HistoryEntry entry;
+    entry.file = fileName;
+    entry.storage = unpacked.type;
+    entry.token = unpacked.token;
+    entry.remoteName = unpacked.file;
+    entry.timestamp = QDateTime::currentDateTime();
+    entry.size = image.size();
+    entry.encoding = encoding;
+    entry.uploadSize = uploadSize;
+    int max = ConfigHandler().uploadHistoryMax();
+    QString filePath = path() + fileName;
 
-    history();
+    HistoryNotifier* historyNotifier = notifier();
+    historyNotifier->writer()->start([=]() mutable {
+        QImage preview = thumbnail(image);
+        QSaveFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly) || !preview.save(&file, "PNG") ||
+            !file.commit()) {
+            AbstractLogger::warning(AbstractLogger::Stderr)
+              << QObject::tr("Unable to save the history thumbnail %1: %2")
+                   .arg(filePath, file.errorString());
+            return;
+        }
+        entry.hash = hash.isEmpty() ? imageHash(image) : hash;
+        entry.thumbnailSize = QFileInfo(filePath).size();
+
+        History().addEntry(entry, max);
+        QMetaObject::invokeMethod(historyNotifier, [=]() {
+            emit historyNotifier->entryAdded(entry, preview);
+        });
+    });
 }
 
 const QList<QString>& History::history()
 {
-    QDir directory(path());
-    QStringList images = directory.entryList(QStringList() << "*.png"
-                                                           << "*.PNG",
-                                             QDir::Files,
-                                             QDir::Time);
-    int cnt = 0;
-    int max = ConfigHandler().uploadHistoryMax();
     m_thumbs.clear();
-    for (const auto& fileName : images) {
-        if (++cnt <= max) {
-            m_thumbs.append(fileName);
-        } else {
-            QFile file(path() + fileName);
-            file.remove();
-        }
+    for (const HistoryEntry& entry : entries()) {
+        m_thumbs.append(entry.file);
     }
     return m_thumbs;
 }
 
+// The entries past the configured maximum are only dropped by the next save
+QList<HistoryEntry> History::entries()
+{
+    QList<HistoryEntry> entries = index().entries();
+    std::reverse(entries.begin(), entries.end());
+    int max = qMax(0, ConfigHandler().uploadHistoryMax());
+    if (entries.size() > max) {
+        entries.resize(max);
+    }
+    return entries;
+}
+
+/**
+ * @brief Forget an entry and delete its thumbnail, in the background.
+ *
+ * HistoryNotifier::entryRemoved() is emitted once it is done.
+ */
+void History::remove(const QString& fileName)
+{
+    notifier()->writer()->start([fileName]() {
+        History history;
+        QFile::remove(history.path() + fileName);
+        HistoryIndex& historyIndex = history.index();
+        if (historyIndex.find(fileName) == nullptr) {
+            return;
+        }
+        if (!historyIndex.remove(fileName)) {
+            warnIndexNotUpdated(historyIndex.filePath());
+            return;
+        }
+        notifyRemoved(fileName);
+    });
+}
+
+HistoryNotifier* History::notifier()
+{
+    static HistoryNotifier* notifier =
+      new HistoryNotifier(QCoreApplication::instance());
+    return notifier;
+}
+
+/**
+ * @brief Look for an upload of `image` to `storage` in the history.
+ *
+ * The image is hashed on the writer, after the saves that are pending, and
+ * `found` is called on the thread of `context` with the hash and the newest
+ * entry with the same hash, or an entry with no file if there is none.
+ *
+ * The history is trusted, the storage is not asked whether the image is still
+ * there. Deleting an upload from the history or from the upload dialog removes
+ * its entry, an image deleted on the server by other means is not noticed.
+ */
+void History::findUpload(
+  const QImage& image,
+  const QString& storage,
+  QObject* context,
+  const std::function<void(const QByteArray&, const HistoryEntry&)>& found)
+{
+    notifier()->writer()->start([=]() {
+        QByteArray hash = imageHash(image);
+        HistoryEntry entry;
+        History history;
+        if (const HistoryEntry* existing =
+              history.index().findHash(hash, storage)) {
+            entry = *existing;
+        }
+        QMetaObject::invokeMethod(
+          context, [found, hash, entry]() { found(hash, entry); });
+    });
+}
+
+/**
+ * @brief Hash of the pixels of an image, regardless of how it is stored.
+ *
+ * Each scanline is hashed with XXH64, seeded with the hash of the previous
+ * one, so that the padding at the end of the lines is left out.
+ */
+QByteArray History::imageHash(const QImage& image)
+{
+    const qint32 header[] = { image.width(), image.height(), image.format() };
+    quint64 hash =
+      xxh64(reinterpret_cast<const uchar*>(header), sizeof(header), 0);
+    const qsizetype rowBytes =
+      (static_cast<qsizetype>(image.width()) * image.depth() + 7) / 8;
+    for (int y = 0; y < image.height(); ++y) {
+        hash = xxh64(image.constScanLine(y), rowBytes, hash);
+    }
+    QByteArray bytes(sizeof(hash), Qt::Uninitialized);
+    qToBigEndian(hash, bytes.data());
+    return bytes;
+}
+
+/**
+ * @brief Thumbnail of an image for the history, at most
+ * HISTORYPIXMAP_MAX_PREVIEW_WIDTH x HISTORYPIXMAP_MAX_PREVIEW_HEIGHT.
+ *
+ * The image is halved with a box filter while it is at least twice the size
+ * of the thumbnail, which is much cheaper than a smooth scale of a full
+ * screenshot, and only the last step is smoothly scaled.
+ */
+QImage History::thumbnail(const QImage& image)
+{
+    if (image.isNull()) {
+        return {};
+    }
+    QSize size = image.size();
+    if (size.height() * HISTORYPIXMAP_MAX_PREVIEW_WIDTH >=
+        size.width() * HISTORYPIXMAP_MAX_PREVIEW_HEIGHT) {
+        size.scale(
+          INT_MAX, HISTORYPIXMAP_MAX_PREVIEW_HEIGHT, Qt::KeepAspectRatio);
+    } else {
+        size.scale(
+          HISTORYPIXMAP_MAX_PREVIEW_WIDTH, INT_MAX, Qt::KeepAspectRatio);
+    }
+
+    QImage scaled =
+      image.convertToFormat(image.hasAlphaChannel()
+                              ? QImage::Format_ARGB32_Premultiplied
+                              : QImage::Format_RGB32);
+    while (scaled.width() >= 2 * size.width() &&
+           scaled.height() >= 2 * size.height()) {
+        scaled = halve(scaled);
+    }
+    return scaled.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+/**
+ * @brief The index, loaded on first use.
+ *
+ * A history without an index, from an older version or with a damaged index,
+ * is indexed from its directory once, by modification time.
+ */
+HistoryIndex& History::index()
+{
+    if (m_index.isLoaded() || m_index.load()) {
+        return m_index;
+    }
+
+    QStringList images = QDir(path()).entryList(QStringList() << "*.png"
+                                                              << "*.PNG",
+                                                QDir::Files,
+                                                QDir::Time | QDir::Reversed);
+    QList<HistoryEntry> entries;
+    for (const QString& fileName : images) {
+        QFileInfo info(path() + fileName);
+        const HistoryFileName& unpacked = unpackFileName(fileName);
+        HistoryEntry entry;
+        entry.file = fileName;
+        entry.storage = unpacked.type;
+        entry.token = unpacked.token;
+        entry.remoteName = unpacked.file;
+        entry.timestamp = info.lastModified();
+        entry.thumbnailSize = info.size();
+        entries.append(entry);
+    }
+    if (!m_index.rebuild(entries)) {
+        warnIndexNotUpdated(m_index.filePath());
+    }
+    return m_index;
+}
+
+// Add an entry, replacing the one saved under the same name, from the writer
+void History::addEntry(const HistoryEntry& entry, int max)
+{
+    HistoryIndex& historyIndex = index();
+    historyIndex.remove(entry.file);
+    if (!historyIndex.append(entry)) {
+        warnIndexNotUpdated(historyIndex.filePath());
+    }
+    prune(max);
+}
+
+// Drop the oldest entries past `max`
+void History::prune(int max)
+{
+    HistoryIndex& historyIndex = index();
+    while (historyIndex.entries().size() > max) {
+        QString oldest = historyIndex.entries().first().file;
+        QFile::remove(path() + oldest);
+        if (!historyIndex.remove(oldest)) {
+            warnIndexNotUpdated(historyIndex.filePath());
+            break;
+        }
+        notifyRemoved(oldest);
+    }
+    if (!historyIndex.compactIfNeeded()) {
+        warnIndexNotUpdated(historyIndex.filePath());
+    }
+}
+
 const HistoryFileName& History::unpackFileName(const QString& fileNamePacked)
 {
     int nPathIndex = fileNamePacked.lastIndexOf("/");
@@ -4,9 +4,14 @@
 #define HISTORYPIXMAP_MAX_PREVIEW_WIDTH 250
 #define HISTORYPIXMAP_MAX_PREVIEW_HEIGHT 100
 
+#include "src/utils/historyindex.h"
+#include <QImage>
 #include <QList>
+#include <QObject>
 #include <QPixmap>
 #include <QString>
+#include <QThreadPool>
+#include <functional>
 
 struct HistoryFileName
 {
@@ -15,21 +20,63 @@ struct HistoryFileName
     QString type;
 };
 
+// Reports the changes to the history made in the background, on the GUI
+// thread. The history is written by its single worker thread.
+class HistoryNotifier : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HistoryNotifier(QObject* parent = nullptr);
+    ~HistoryNotifier();
+
+    QThreadPool* writer();
+
+signals:
+    void entryAdded(const HistoryEntry& entry, const QImage& thumbnail);
+    void entryRemoved(const QString& file);
+
+private:
+    QThreadPool m_writer;
+};
+
 class History
 {
 public:
     History();
 
+    static HistoryNotifier* notifier();
+
     void save(const QPixmap&, const QString&);
+    void save(const QImage& image,
+              const QString& fileName,
+              const QString& encoding = QString(),
+              qint64 uploadSize = 0,
+              const QByteArray& hash = QByteArray());
     const QList<QString>& history();
+    // Newest first
+    QList<HistoryEntry> entries();
+    void remove(const QString& fileName);
     const QString& path();
 
+    static void findUpload(
+      const QImage& image,
+      const QString& storage,
+      QObject* context,
+      const std::function<void(const QByteArray&, const HistoryEntry&)>& found);
+    static QByteArray imageHash(const QImage& image);
+    static QImage thumbnail(const QImage& image);
+
     const HistoryFileName& unpackFileName(const QString&);
     const QString& packFileName(const QString&, const QString&, const QString&);
 
 private:
+    HistoryIndex& index();
+    void prune(int max);
+    void addEntry(const HistoryEntry& entry, int max);
+
     QString m_historyPath;
     QList<QString> m_thumbs;
+    HistoryIndex m_index;
 
     // temporary variables
     QString m_packedFileName;
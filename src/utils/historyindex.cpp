@@ -0,0 +1,375 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "historyindex.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QLockFile>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QtEndian>
+#include <array>
+
+#define HISTORY_INDEX_FILE "index.log"
+#define HISTORY_INDEX_MAGIC 0x46534849
+#define HISTORY_INDEX_VERSION 3
+// Taken by the writers of every process, readers don't wait for it
+#define HISTORY_INDEX_LOCK_FILE "index.lock"
+// The log is not compacted before it holds this many records
+#define HISTORY_INDEX_MIN_COMPACT 64
+
+namespace {
+
+enum RecordType : quint8
+{
+    ADD_RECORD = 1,
+    REMOVE_RECORD = 2,
+};
+
+// Payload size and checksum
+const int RECORD_HEADER_SIZE = 2 * sizeof(quint32);
+
+// CRC-32 of `data`, with the polynomial of zlib and PNG
+quint32 crc32(const QByteArray& data)
+{
+    static const std::array<quint32, 256> table = []() {
+        std::array<quint32, 256> crcs{};
+        for (quint32 i = 0; i < crcs.size(); ++i) {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) != 0 ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+            }
+            crcs[i] = crc;
+        }
+        return crcs;
+    }();
+    quint32 crc = 0xFFFFFFFF;
+    for (const char byte : data) {
+        crc = table[(crc ^ static_cast<quint8>(byte)) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Magic, version and generation
+const int FILE_HEADER_SIZE = 3 * sizeof(quint32);
+
+// Every rewrite of the log gets a new generation, which tells the writers
+// that what they read of the previous log is gone
+QByteArray fileHeader()
+{
+    QByteArray header(FILE_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(HISTORY_INDEX_MAGIC, header.data());
+    qToBigEndian<quint32>(HISTORY_INDEX_VERSION,
+                          header.data() + sizeof(quint32));
+    qToBigEndian<quint32>(QRandomGenerator::global()->generate(),
+                          header.data() + 2 * sizeof(quint32));
+    return header;
+}
+
+bool isFileHeader(const QByteArray& data)
+{
+    const QByteArray header = fileHeader();
+    return data.size() >= FILE_HEADER_SIZE &&
+           data.startsWith(header.left(2 * sizeof(quint32)));
+}
+
+QByteArray record(const QByteArray& payload)
+{
+    QByteArray bytes(RECORD_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(payload.size(), bytes.data());
+    qToBigEndian<quint32>(crc32(payload), bytes.data() + sizeof(quint32));
+    return bytes + payload;
+}
+
+// New fields go at the end of the payloads, where older readers ignore them
+QByteArray addRecord(const HistoryEntry& entry)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << static_cast<quint8>(ADD_RECORD) << entry.file << entry.storage
+        << entry.token << entry.remoteName
+        << entry.timestamp.toMSecsSinceEpoch()
+        << static_cast<qint32>(entry.size.width())
+        << static_cast<qint32>(entry.size.height()) << entry.hash
+        << entry.thumbnailSize << entry.encoding << entry.uploadSize;
+    return record(payload);
+}
+
+QByteArray removeRecord(const QString& file)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << static_cast<quint8>(REMOVE_RECORD) << file;
+    return record(payload);
+}
+
+} // unnamed namespace
+
+HistoryIndex::HistoryIndex(const QString& directory)
+  : m_directory(directory)
+{}
+
+/**
+ * @brief Read the entries from the log.
+ *
+ * The log is only read: a damaged tail, which may be a record another process
+ * is still writing, is left to the next writer.
+ * @return false if there is no log or it can't be read, it has to be rebuilt
+ */
+bool HistoryIndex::load()
+{
+    m_loaded = true;
+    QFile file(filePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_entries.clear();
+        m_records = 0;
+        m_header.clear();
+        m_end = 0;
+        return false;
+    }
+    return readAll(file);
+}
+
+bool HistoryIndex::isLoaded() const
+{
+    return m_loaded;
+}
+
+const QList<HistoryEntry>& HistoryIndex::entries() const
+{
+    return m_entries;
+}
+
+const HistoryEntry* HistoryIndex::find(const QString& file) const
+{
+    for (const HistoryEntry& entry : m_entries) {
+        if (entry.file == file) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+// The newest entry of the image with `hash` uploaded to `storage`
+const HistoryEntry* HistoryIndex::findHash(const QByteArray& hash,
+                                           const QString& storage) const
+{
+    if (hash.isEmpty()) {
+        return nullptr;
+    }
+    for (auto it = m_entries.crbegin(); it != m_entries.crend(); ++it) {
+        if (it->hash == hash && it->storage == storage) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+bool HistoryIndex::append(const HistoryEntry& entry)
+{
+    if (!appendRecord(addRecord(entry))) {
+        return false;
+    }
+    m_entries.append(entry);
+    return true;
+}
+
+bool HistoryIndex::remove(const QString& file)
+{
+    if (find(file) == nullptr || !appendRecord(removeRecord(file))) {
+        return false;
+    }
+    m_entries.removeIf(
+      [&file](const HistoryEntry& e) { return e.file == file; });
+    return true;
+}
+
+// Replace the log with `entries`, oldest first
+bool HistoryIndex::rebuild(const QList<HistoryEntry>& entries)
+{
+    m_entries = entries;
+    m_loaded = true;
+    QLockFile lock(lockPath());
+    return lock.lock() && writeAll(entries);
+}
+
+/**
+ * @brief Rewrite the log with only the live entries once most of its
+ * records are dead.
+ */
+bool HistoryIndex::compactIfNeeded()
+{
+    if (m_records < HISTORY_INDEX_MIN_COMPACT ||
+        m_records - m_entries.size() <= m_entries.size()) {
+        return true;
+    }
+    QLockFile lock(lockPath());
+    if (!lock.lock()) {
+        return false;
+    }
+    // With the records other processes appended since the log was read
+    QFile file(filePath());
+    if (file.open(QIODevice::ReadOnly) && !readNew(file)) {
+        return false;
+    }
+    file.close();
+    if (m_records < HISTORY_INDEX_MIN_COMPACT ||
+        m_records - m_entries.size() <= m_entries.size()) {
+        return true;
+    }
+    return writeAll(m_entries);
+}
+
+QString HistoryIndex::filePath() const
+{
+    return QDir(m_directory).filePath(QStringLiteral(HISTORY_INDEX_FILE));
+}
+
+QString HistoryIndex::lockPath() const
+{
+    return QDir(m_directory).filePath(QStringLiteral(HISTORY_INDEX_LOCK_FILE));
+}
+
+// Replace the entries with the ones of the whole log
+bool HistoryIndex::readAll(QFile& file)
+{
+    m_entries.clear();
+    m_records = 0;
+    m_header.clear();
+    m_end = 0;
+    if (!file.seek(0)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    if (!isFileHeader(data)) {
+        return false;
+    }
+    m_header = data.left(FILE_HEADER_SIZE);
+    m_end = FILE_HEADER_SIZE + readRecords(data.mid(FILE_HEADER_SIZE));
+    return true;
+}
+
+/**
+ * @brief Apply the records appended to the log since it was last read.
+ *
+ * The log is read again from the start when it was rewritten since then, as
+ * its header tells, or cut off before the end of what was read.
+ */
+bool HistoryIndex::readNew(QFile& file)
+{
+    if (m_header.isEmpty() || file.size() < m_end || !file.seek(0) ||
+        file.read(FILE_HEADER_SIZE) != m_header || !file.seek(m_end)) {
+        return readAll(file);
+    }
+    m_end += readRecords(file.readAll());
+    return true;
+}
+
+/**
+ * @brief Apply the records of `data` to the entries.
+ * @return the end of the last complete record in `data`
+ */
+qsizetype HistoryIndex::readRecords(const QByteArray& data)
+{
+    qsizetype pos = 0;
+    while (data.size() - pos >= RECORD_HEADER_SIZE) {
+        const char* bytes = data.constData() + pos;
+        const quint32 size = qFromBigEndian<quint32>(bytes);
+        const quint32 checksum =
+          qFromBigEndian<quint32>(bytes + sizeof(quint32));
+        if (size > data.size() - pos - RECORD_HEADER_SIZE) {
+            break;
+        }
+        const QByteArray payload = data.mid(pos + RECORD_HEADER_SIZE, size);
+        if (crc32(payload) != checksum) {
+            break;
+        }
+        pos += RECORD_HEADER_SIZE + size;
+        ++m_records;
+
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_6_0);
+        quint8 type = 0;
+        in >> type;
+        if (type == ADD_RECORD) {
+            HistoryEntry entry;
+            qint64 timestamp = 0;
+            qint32 width = 0;
+            qint32 height = 0;
+            in >> entry.file >> entry.storage >> entry.token >>
+              entry.remoteName >> timestamp >> width >> height >>
+              entry.hash >> entry.thumbnailSize;
+            // Added later
+            if (!in.atEnd()) {
+                in >> entry.encoding >> entry.uploadSize;
+            }
+            entry.timestamp = QDateTime::fromMSecsSinceEpoch(timestamp);
+            entry.size = QSize(width, height);
+            m_entries.append(entry);
+        } else if (type == REMOVE_RECORD) {
+            QString file;
+            in >> file;
+            m_entries.removeIf(
+              [&file](const HistoryEntry& e) { return e.file == file; });
+        }
+    }
+    return pos;
+}
+
+bool HistoryIndex::appendRecord(const QByteArray& record)
+{
+    // No other writer is in the middle of a record while the lock is held, so
+    // a damaged tail was left by a crash and can be cut off
+    QLockFile lock(lockPath());
+    if (!lock.lock()) {
+        return false;
+    }
+    QFile file(filePath());
+    // One write per record, so that a crash can only damage the last one
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+        return false;
+    }
+    QByteArray bytes = record;
+    if (file.size() == 0) {
+        m_entries.clear();
+        m_records = 0;
+        m_header = fileHeader();
+        m_end = 0;
+        bytes.prepend(m_header);
+    } else {
+        // With the records other processes appended since the log was read
+        if (!readNew(file) ||
+            (m_end < file.size() && !file.resize(m_end))) {
+            return false;
+        }
+    }
+    if (!file.seek(m_end) || file.write(bytes) != bytes.size()) {
+        return false;
+    }
+    m_end += bytes.size();
+    ++m_records;
+    return true;
+}
+
+bool HistoryIndex::writeAll(const QList<HistoryEntry>& entries)
+{
+    QSaveFile file(filePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    const QByteArray header = fileHeader();
+    QByteArray bytes = header;
+    for (const HistoryEntry& entry : entries) {
+        bytes += addRecord(entry);
+    }
+    if (file.write(bytes) != bytes.size() || !file.commit()) {
+        return false;
+    }
+    m_records = entries.size();
+    m_header = header;
+    m_end = bytes.size();
+    return true;
+}
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QSize>
+#include <QString>
+
+class QFile;
+
+struct HistoryEntry
+{
+    // Thumbnail, relative to the history directory
+    QString file;
+    QString storage;
+    QString token;
+    // Name of the image on the storage
+    QString remoteName;
+    QDateTime timestamp;
+    // Of the uploaded image, not of the thumbnail
+    QSize size;
+    QByteArray hash;
+    qint64 thumbnailSize{ 0 };
+    // How the image was encoded for the upload, see UploadOptimizer
+    QString encoding;
+    qint64 uploadSize{ 0 };
+};
+
+// Append-only log of the history entries, kept next to their thumbnails.
+//
+// Adding or removing an entry appends one record with a single write, so the
+// log only needs the entries in memory and never a directory scan. Every
+// record carries its length and a CRC-32: loading stops at a record that is
+// incomplete or damaged. Readers never change the log. Writers, in any
+// process, hold a lock file while they append, which is when a tail left by a
+// crash is cut off. Writers only read the records appended since they last
+// read the log. Once most records are removals or removed entries, the log is
+// rewritten with only the live entries through QSaveFile, which replaces it
+// atomically.
+class HistoryIndex
+{
+public:
+    explicit HistoryIndex(const QString& directory);
+
+    bool load();
+    bool isLoaded() const;
+    // Oldest first
+    const QList<HistoryEntry>& entries() const;
+    const HistoryEntry* find(const QString& file) const;
+    const HistoryEntry* findHash(const QByteArray& hash,
+                                 const QString& storage) const;
+
+    bool append(const HistoryEntry& entry);
+    bool remove(const QString& file);
+    bool rebuild(const QList<HistoryEntry>& entries);
+    bool compactIfNeeded();
+
+    QString filePath() const;
+
+private:
+    QString lockPath() const;
+    bool readAll(QFile& file);
+    bool readNew(QFile& file);
+    qsizetype readRecords(const QByteArray& data);
+    bool appendRecord(const QByteArray& record);
+    bool writeAll(const QList<HistoryEntry>& entries);
+
+    QString m_directory;
+    QList<HistoryEntry> m_entries;
+    int m_records{ 0 };
+    // Header of the log that was read, and the end of its last record read
+    QByteArray m_header;
+    qsizetype m_end{ 0 };
+    bool m_loaded{ false };
+};
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "historythumbnailcache.h"
+#include "src/utils/history.h"
+#include <QCoreApplication>
+#include <QImageReader>
+
+// Decoded thumbnails kept in memory, in KiB
+#define HISTORY_THUMBNAIL_CACHE_SIZE 32768
+#define HISTORY_THUMBNAIL_THREADS 2
+
+HistoryThumbnailCache::HistoryThumbnailCache(QObject* parent)
+  : QObject(parent)
+  , m_cache(HISTORY_THUMBNAIL_CACHE_SIZE)
+{
+    m_pool.setMaxThreadCount(HISTORY_THUMBNAIL_THREADS);
+}
+
+HistoryThumbnailCache::~HistoryThumbnailCache()
+{
+    m_pool.waitForDone();
+}
+
+HistoryThumbnailCache* HistoryThumbnailCache::instance()
+{
+    static HistoryThumbnailCache* cache =
+      new HistoryThumbnailCache(QCoreApplication::instance());
+    return cache;
+}
+
+/**
+ * @brief The thumbnail of `path`, or a null pixmap while it is decoded.
+ *
+ * thumbnailReady() is emitted with `key` once the thumbnail is decoded.
+ */
+QPixmap HistoryThumbnailCache::thumbnail(const QString& key,
+                                         const QString& path)
+{
+    if (QPixmap* pixmap = m_cache.object(key)) {
+        return *pixmap;
+    }
+    if (m_pending.contains(key) || m_failed.contains(key)) {
+        return {};
+    }
+    m_pending.insert(key);
+    m_pool.start([this, key, path]() {
+        QImageReader reader(path);
+        QSize size = reader.size();
+        QSize bounds(HISTORYPIXMAP_MAX_PREVIEW_WIDTH,
+                     HISTORYPIXMAP_MAX_PREVIEW_HEIGHT);
+        if (size.isValid() && (size.width() > bounds.width() ||
+                               size.height() > bounds.height())) {
+            reader.setScaledSize(size.scaled(bounds, Qt::KeepAspectRatio));
+        }
+        QImage image = reader.read();
+        QMetaObject::invokeMethod(
+          this,
+          [this, key, image]() { onDecoded(key, image); },
+          Qt::QueuedConnection);
+    });
+    return {};
+}
+
+void HistoryThumbnailCache::remove(const QString& key)
+{
+    m_cache.remove(key);
+    m_failed.remove(key);
+}
+
+// Adds a thumbnail that is already in memory, like a newly saved one
+void HistoryThumbnailCache::insert(const QString& key, const QImage& image)
+{
+    m_failed.remove(key);
+    m_cache.insert(key,
+                   new QPixmap(QPixmap::fromImage(image)),
+                   qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+}
+
+void HistoryThumbnailCache::onDecoded(const QString& key, const QImage& image)
+{
+    m_pending.remove(key);
+    if (image.isNull()) {
+        m_failed.insert(key);
+    } else {
+        insert(key, image);
+    }
+    emit thumbnailReady(key);
+}
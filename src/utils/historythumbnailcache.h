@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QThreadPool>
+
+/**
+ * @brief Thumbnails of the upload history, decoded in the background.
+ *
+ * The thumbnails are read at their display size by a couple of worker
+ * threads and kept in a least recently used cache that outlives the history
+ * window, so that opening it again shows them right away.
+ */
+class HistoryThumbnailCache : public QObject
+{
+    Q_OBJECT
+public:
+    static HistoryThumbnailCache* instance();
+    ~HistoryThumbnailCache();
+
+    QPixmap thumbnail(const QString& key, const QString& path);
+    void insert(const QString& key, const QImage& image);
+    void remove(const QString& key);
+
+signals:
+    void thumbnailReady(const QString& key);
+
+private:
+    explicit HistoryThumbnailCache(QObject* parent = nullptr);
+
+    void onDecoded(const QString& key, const QImage& image);
+
+    QCache<QString, QPixmap> m_cache;
+    QSet<QString> m_pending;
+    // Files that could not be read, not retried
+    QSet<QString> m_failed;
+    QThreadPool m_pool;
+};
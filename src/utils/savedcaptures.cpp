@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "savedcaptures.h"
+#include "src/utils/history.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QSaveFile>
+#include <QStringList>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#elif defined(Q_OS_UNIX)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+#define SAVED_CAPTURES_FILE "saved.index"
+// Saves remembered, the oldest are forgotten first
+#define SAVED_CAPTURES_MAX 64
+
+namespace {
+
+#if defined(Q_OS_LINUX)
+// A copy of `source` sharing its blocks until either file changes, on the
+// file systems that support it, like Btrfs and XFS
+bool reflink(const QString& source, const QString& target)
+{
+    int in =
+      ::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return false;
+    }
+    int out = ::open(QFile::encodeName(target).constData(),
+                     O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                     0666);
+    bool cloned = out >= 0 && ::ioctl(out, FICLONE, in) == 0;
+    if (out >= 0) {
+        ::close(out);
+        if (!cloned) {
+            ::unlink(QFile::encodeName(target).constData());
+        }
+    }
+    ::close(in);
+    return cloned;
+}
+#endif
+
+} // unnamed namespace
+
+SavedCaptures::SavedCaptures()
+  : m_filePath(History().path() + SAVED_CAPTURES_FILE)
+{
+    // One entry per line: key, size, modification time in ms and path
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine());
+        if (line.endsWith('\n')) {
+            line.chop(1);
+        }
+        const QStringList fields = line.split(' ');
+        if (fields.size() < 4) {
+            continue;
+        }
+        Entry entry;
+        entry.key = fields[0].toLatin1();
+        entry.size = fields[1].toLongLong();
+        entry.modified = QDateTime::fromMSecsSinceEpoch(fields[2].toLongLong());
+        // The path may have spaces
+        entry.path = line.section(' ', 3);
+        m_entries.append(entry);
+    }
+}
+
+/**
+ * @brief The key of `image` saved as `suffix` with `quality`.
+ */
+QByteArray SavedCaptures::key(const QImage& image,
+                              const QString& suffix,
+                              int quality)
+{
+    return History::imageHash(image).toHex() + '-' + suffix.toUtf8() + '-' +
+           QByteArray::number(quality);
+}
+
+/**
+ * @brief The file saved with `key`, if it is still there as it was saved.
+ */
+QString SavedCaptures::find(const QByteArray& key) const
+{
+    for (auto it = m_entries.crbegin(); it != m_entries.crend(); ++it) {
+        if (it->key != key) {
+            continue;
+        }
+        QFileInfo info(it->path);
+        if (info.isFile() && info.size() == it->size &&
+            info.lastModified() == it->modified) {
+            return it->path;
+        }
+    }
+    return {};
+}
+
+void SavedCaptures::add(const QByteArray& key, const QString& filePath)
+{
+    QFileInfo info(filePath);
+    m_entries.removeIf(
+      [&filePath](const Entry& entry) { return entry.path == filePath; });
+    m_entries.append({ key, info.size(), info.lastModified(), filePath });
+    if (m_entries.size() > SAVED_CAPTURES_MAX) {
+        m_entries.remove(0, m_entries.size() - SAVED_CAPTURES_MAX);
+    }
+    write();
+}
+
+/**
+ * @brief Make `target` a file with the content of `source`, without copying
+ * it: a reflink where the file system supports it, a hard link otherwise.
+ *
+ * `target` must not exist.
+ */
+bool SavedCaptures::link(const QString& source, const QString& target)
+{
+#if defined(Q_OS_LINUX)
+    if (reflink(source, target)) {
+        return true;
+    }
+#endif
+#if defined(Q_OS_UNIX)
+    return ::link(QFile::encodeName(source).constData(),
+                  QFile::encodeName(target).constData()) == 0;
+#elif defined(Q_OS_WIN)
+    return CreateHardLinkW(reinterpret_cast<LPCWSTR>(target.utf16()),
+                           reinterpret_cast<LPCWSTR>(source.utf16()),
+                           nullptr) != 0;
+#else
+    return false;
+#endif
+}
+
+void SavedCaptures::write() const
+{
+    QByteArray bytes;
+    for (const Entry& entry : m_entries) {
+        bytes += entry.key + ' ' + QByteArray::number(entry.size) + ' ' +
+                 QByteArray::number(entry.modified.toMSecsSinceEpoch()) + ' ' +
+                 entry.path.toUtf8() + '\n';
+    }
+    QSaveFile file(m_filePath);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(bytes);
+        file.commit();
+    }
+}
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+class QImage;
+
+/**
+ * @brief Content-addressed index of the captures saved to files, kept in the
+ * history directory.
+ *
+ * A capture is identified by the hash of its pixels and the format and
+ * quality it was encoded with, so that saving the same capture again can
+ * link the file saved before instead of encoding it again. Entries whose file
+ * was changed or deleted since are ignored. Only the most recent saves are
+ * remembered.
+ */
+class SavedCaptures
+{
+public:
+    SavedCaptures();
+
+    static QByteArray key(const QImage& image,
+                          const QString& suffix,
+                          int quality);
+
+    QString find(const QByteArray& key) const;
+    void add(const QByteArray& key, const QString& filePath);
+
+    static bool link(const QString& source, const QString& target);
+
+private:
+    struct Entry
+    {
+        QByteArray key;
+        qint64 size{ 0 };
+        QDateTime modified;
+        QString path;
+    };
+
+    void write() const;
+
+    QString m_filePath;
+    QList<Entry> m_entries;
+};
@@ -8,20 +8,83 @@
 #include "src/utils/filenamehandler.h"
 #include "src/utils/systemnotification.h"
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QGuiApplication>
+#include <QPainter>
 #include <QPixmap>
 #include <QProcess>
+#include <QPromise>
 #include <QScreen>
+#include <QThreadPool>
+#include <memory>
+
+#if defined(USE_XCB_SHM)
+#include "xcbshmgrabber.h"
+#endif
 
 #if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
 #include "request.h"
-#include <QDBusInterface>
-#include <QDBusReply>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
 #include <QDir>
+#include <QImageReader>
 #include <QUrl>
 #include <QUuid>
 #endif
 
+namespace {
+
+template<typename T>
+QFuture<T> finishedGrab(const T& result)
+{
+    QPromise<T> promise;
+    QFuture<T> future = promise.future();
+    promise.start();
+    promise.addResult(result);
+    promise.finish();
+    return future;
+}
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
+// Decodes the file written by the portal into a format the raster engine
+// paints without converting, so the pixmap can adopt the pixels as they are
+QImage readPortalImage(const QString& path,
+                       const QRect& approxPhysGeo,
+                       const QRect& logicalGeo,
+                       qreal appRatio,
+                       QString& error)
+{
+    QImageReader reader(path);
+    QImage image;
+    if (!reader.read(&image)) {
+        error = reader.errorString();
+        return {};
+    }
+    if (image.format() != QImage::Format_RGB32 &&
+        image.format() != QImage::Format_ARGB32_Premultiplied) {
+        image.convertTo(image.hasAlphaChannel()
+                          ? QImage::Format_ARGB32_Premultiplied
+                          : QImage::Format_RGB32);
+    }
+
+    // we calculate an approximated physical desktop geometry based on
+    // dpr(provided by qt), we calculate the logical desktop geometry
+    // later, this is the accurate size, more info:
+    // https://bugreports.qt.io/browse/QTBUG-135612
+    if (image.size() == approxPhysGeo.size()) {
+        // which means the image is physical size and the dpr is correct.
+        image.setDevicePixelRatio(appRatio);
+    } else if (image.size() != logicalGeo.size()) {
+        // which means the image is physical size and the dpr is not correct,
+        // a logical size needs no action.
+        image.setDevicePixelRatio(image.height() * 1.0f / logicalGeo.height());
+    }
+    return image;
+}
+#endif
+
+} // unnamed namespace
+
 ScreenGrabber::ScreenGrabber(QObject* parent)
   : QObject(parent)
 {}
@@ -57,110 +120,113 @@ void ScreenGrabber::generalGrimScreenshot(bool& ok, QPixmap& res)
 #endif
 }
 
-void ScreenGrabber::freeDesktopPortal(bool& ok, QPixmap& res)
+QFuture<QPixmap> ScreenGrabber::freeDesktopPortal()
 {
-
 #if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
-    QDBusInterface screenshotInterface(
-      QStringLiteral("org.freedesktop.portal.Desktop"),
-      QStringLiteral("/org/freedesktop/portal/desktop"),
-      QStringLiteral("org.freedesktop.portal.Screenshot"));
+    auto promise = std::make_shared<QPromise<QPixmap>>();
+    QFuture<QPixmap> future = promise->future();
+    promise->start();
+
+    QDBusConnection bus = QDBusConnection::sessionBus();
 
     // unique token
     QString token =
       QUuid::createUuid().toString().remove('-').remove('{').remove('}');
 
-    // premake interface
+    // premake interface, it is not owned by the grabber and lives until the
+    // portal has answered
     auto* request = new OrgFreedesktopPortalRequestInterface(
       QStringLiteral("org.freedesktop.portal.Desktop"),
       "/org/freedesktop/portal/desktop/request/" +
-        QDBusConnection::sessionBus().baseService().remove(':').replace('.',
-                                                                        '_') +
-        "/" + token,
-      QDBusConnection::sessionBus(),
-      this);
-
-    QEventLoop loop;
-    const auto gotSignal = [&res, &loop, this](uint status,
-                                               const QVariantMap& map) {
-        if (status == 0) {
-            // Parse this as URI to handle unicode properly
-            QUrl uri = map.value("uri").toString();
-            QString uriString = uri.toLocalFile();
-            res = QPixmap(uriString);
-
-            // we calculate an approximated physical desktop geometry based on
-            // dpr(provided by qt), we calculate the logical desktop geometry
-            // later, this is the accurate size, more info:
-            // https://bugreports.qt.io/browse/QTBUG-135612
-            QRect approxPhysGeo = desktopGeometry();
-            QRect logicalGeo = logicalDesktopGeometry();
-            if (res.size() ==
-                approxPhysGeo.size()) // which means the res is physical size
-                                      // and the dpr is correct.
-            {
-                res.setDevicePixelRatio(qApp->devicePixelRatio());
-            } else if (res.size() ==
-                       logicalGeo.size()) // which means the res is logical size
-                                          // and we need to do nothing.
-            {
-                // No action needed
-            } else // which means the res is physical size and the dpr is not
-                   // correct.
-            {
-                res.setDevicePixelRatio(res.height() * 1.0f /
-                                        logicalGeo.height());
-            }
-            QFile imgFile(uriString);
-            imgFile.remove();
+        bus.baseService().remove(':').replace('.', '_') + "/" + token,
+      bus);
+
+    const auto finish = [promise, request](const QPixmap& res) {
+        if (res.isNull()) {
+            AbstractLogger::error() << tr("Unable to capture screen");
         }
-        loop.quit();
+        promise->addResult(res);
+        promise->finish();
+        request->deleteLater();
     };
 
-    // prevent racy situations and listen before calling screenshot
-    QMetaObject::Connection conn = QObject::connect(
-      request, &org::freedesktop::portal::Request::Response, gotSignal);
+    // The image is decoded on a worker, which must not touch the screens
+    const QRect physicalGeometry = desktopGeometry();
+    const QRect logicalGeometry = logicalDesktopGeometry();
+    const qreal appRatio = qApp->devicePixelRatio();
 
-    screenshotInterface.call(
-      QStringLiteral("Screenshot"),
-      "",
-      QMap<QString, QVariant>({ { "handle_token", QVariant(token) },
-                                { "interactive", QVariant(false) } }));
+    const auto gotSignal = [=](uint status, const QVariantMap& map) {
+        if (status != 0) {
+            finish({});
+            return;
+        }
+        // Parse this as URI to handle unicode properly
+        QUrl uri = map.value("uri").toString();
+        QString path = uri.toLocalFile();
+        QThreadPool::globalInstance()->start([=]() {
+            QString error;
+            QImage image = readPortalImage(
+              path, physicalGeometry, logicalGeometry, appRatio, error);
+            QFile::remove(path);
+            // Pixmaps can only be created on the GUI thread
+            QMetaObject::invokeMethod(
+              request,
+              [=, image = std::move(image)]() mutable {
+                  if (!error.isEmpty()) {
+                      AbstractLogger::error() << error;
+                  }
+                  finish(QPixmap::fromImage(std::move(image),
+                                            Qt::NoFormatConversion));
+              },
+              Qt::QueuedConnection);
+        });
+    };
 
-    loop.exec();
-    QObject::disconnect(conn);
-    request->Close().waitForFinished();
-    request->deleteLater();
+    // prevent racy situations and listen before calling screenshot
+    QObject::connect(request,
+                     &org::freedesktop::portal::Request::Response,
+                     request,
+                     gotSignal,
+                     Qt::SingleShotConnection);
 
-    if (res.isNull()) {
-        ok = false;
-    }
+    QDBusMessage message = QDBusMessage::createMethodCall(
+      QStringLiteral("org.freedesktop.portal.Desktop"),
+      QStringLiteral("/org/freedesktop/portal/desktop"),
+      QStringLiteral("org.freedesktop.portal.Screenshot"),
+      QStringLiteral("Screenshot"));
+    message << QString()
+            << QVariantMap({ { "handle_token", QVariant(token) },
+                             { "interactive", QVariant(false) } });
+    auto* watcher =
+      new QDBusPendingCallWatcher(bus.asyncCall(message), request);
+    QObject::connect(watcher,
+                     &QDBusPendingCallWatcher::finished,
+                     request,
+                     [finish](QDBusPendingCallWatcher* call) {
+                         call->deleteLater();
+                         // Without a portal there will be no response either
+                         if (call->isError()) {
+                             AbstractLogger::error() << call->error().message();
+                             finish({});
+                         }
+                     });
+    return future;
+#else
+    return finishedGrab(QPixmap());
 #endif
 }
-QPixmap ScreenGrabber::grabEntireDesktop(bool& ok)
-{
-    ok = true;
-    int wid = 0;
 
-#if defined(Q_OS_MACOS)
-    QScreen* currentScreen = QGuiAppCurrentScreen().currentScreen();
-    QPixmap screenPixmap(
-      currentScreen->grabWindow(wid,
-                                currentScreen->geometry().x(),
-                                currentScreen->geometry().y(),
-                                currentScreen->geometry().width(),
-                                currentScreen->geometry().height()));
-    screenPixmap.setDevicePixelRatio(currentScreen->devicePixelRatio());
-    return screenPixmap;
-#elif defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
+QFuture<QPixmap> ScreenGrabber::grabEntireDesktop()
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
     if (m_info.waylandDetected()) {
+        bool ok = true;
         QPixmap res;
         // handle screenshot based on DE
         switch (m_info.windowManager()) {
             case DesktopInfo::GNOME:
             case DesktopInfo::KDE:
-                freeDesktopPortal(ok, res);
-                break;
+                return freeDesktopPortal();
             case DesktopInfo::QTILE:
             case DesktopInfo::WLROOTS:
             case DesktopInfo::HYPRLAND:
@@ -175,16 +241,15 @@ QPixmap ScreenGrabber::grabEntireDesktop(bool& ok)
                           "useGrimAdapter setting in flameshot.ini to activate "
                           "the grim-based general wayland screenshot adapter");
                     }
-                    freeDesktopPortal(ok, res);
-                } else {
-                    if (!ConfigHandler().disabledGrimWarning()) {
-                        AbstractLogger::warning() << tr(
-                          "grim's screenshot component is implemented based on "
-                          "wlroots, it may not be used in GNOME or similar "
-                          "desktop environments");
-                    }
-                    generalGrimScreenshot(ok, res);
+                    return freeDesktopPortal();
                 }
+                if (!ConfigHandler().disabledGrimWarning()) {
+                    AbstractLogger::warning() << tr(
+                      "grim's screenshot component is implemented based on "
+                      "wlroots, it may not be used in GNOME or similar "
+                      "desktop environments");
+                }
+                generalGrimScreenshot(ok, res);
                 break;
             }
             default:
@@ -199,8 +264,53 @@ QPixmap ScreenGrabber::grabEntireDesktop(bool& ok)
         }
         if (!ok) {
             AbstractLogger::error() << tr("Unable to capture screen");
+            res = QPixmap();
+        }
+        return finishedGrab(res);
+    }
+#endif
+    bool ok = true;
+    QPixmap res = grabNativeDesktop(ok);
+    if (!ok) {
+        AbstractLogger::error() << tr("Unable to capture screen");
+        res = QPixmap();
+    }
+    return finishedGrab(res);
+}
+
+QPixmap ScreenGrabber::grabNativeDesktop(bool& ok)
+{
+    ok = true;
+    int wid = 0;
+
+#if defined(Q_OS_MACOS)
+    QScreen* currentScreen = QGuiAppCurrentScreen().currentScreen();
+    QPixmap screenPixmap(
+      currentScreen->grabWindow(wid,
+                                currentScreen->geometry().x(),
+                                currentScreen->geometry().y(),
+                                currentScreen->geometry().width(),
+                                currentScreen->geometry().height()));
+    screenPixmap.setDevicePixelRatio(currentScreen->devicePixelRatio());
+    return screenPixmap;
+#endif
+#if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
+    if (ConfigHandler().grabScreensSeparately()) {
+        return grabScreensSeparately(ok);
+    }
+#endif
+#if defined(USE_XCB_SHM)
+    XcbShmGrabber* shmGrabber = XcbShmGrabber::instance();
+    if (shmGrabber->isAvailable()) {
+        QImage image = shmGrabber->grab(shmGrabber->rootGeometry());
+        if (!image.isNull()) {
+            // The image lives in the reused segment, the pixmap gets its own
+            // copy of the pixels
+            QPixmap p(QPixmap::fromImage(image));
+            QScreen* screen = qApp->screenAt(QCursor::pos());
+            p.setDevicePixelRatio(screen->devicePixelRatio());
+            return p;
         }
-        return res;
     }
 #endif
 #if defined(Q_OS_LINUX) || defined(Q_OS_UNIX) || defined(Q_OS_WIN)
@@ -213,6 +323,84 @@ QPixmap ScreenGrabber::grabEntireDesktop(bool& ok)
 #endif
 }
 
+/**
+ * @brief Grab every screen on its own and stitch the results.
+ *
+ * Each screen is grabbed at its own native resolution and placed at its native
+ * position, so heads with different scale factors line up the same way they
+ * do in the root window. QScreen::grabWindow is only safe on the GUI thread,
+ * so the screens are grabbed one after the other there, and only their
+ * conversion to the desktop format runs on a worker each. The time spent on
+ * each screen is logged.
+ */
+QPixmap ScreenGrabber::grabScreensSeparately(bool& ok)
+{
+    ok = true;
+    const QList<QScreen*> screens = QGuiApplication::screens();
+    QVector<QImage> images(screens.size());
+    QVector<qint64> nsecs(screens.size());
+
+    QElapsedTimer total;
+    total.start();
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, static_cast<int>(screens.size())));
+    for (int i = 0; i < screens.size(); ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        images[i] = screens.at(i)->grabWindow(0).toImage();
+        nsecs[i] = timer.nsecsElapsed();
+        if (images.at(i).isNull()) {
+            ok = false;
+            AbstractLogger::error()
+              << tr("Unable to capture screen %1").arg(screens.at(i)->name());
+            return {};
+        }
+        // While the next screen is grabbed
+        QImage* image = &images[i];
+        pool.start([image]() {
+            image->convertTo(QImage::Format_RGB32);
+            image->setDevicePixelRatio(1);
+        });
+    }
+    pool.waitForDone();
+
+    // Qt keeps the screen origin in native pixels, only the size is scaled
+    QRect nativeGeometry;
+    QVector<QRect> nativeRects;
+    QStringList timings;
+    for (int i = 0; i < screens.size(); ++i) {
+        QRect rect(screens.at(i)->geometry().topLeft(), images.at(i).size());
+        nativeRects << rect;
+        nativeGeometry = nativeGeometry.united(rect);
+        timings << QStringLiteral("%1 %2x%3@%4 %5 ms")
+                     .arg(screens.at(i)->name())
+                     .arg(rect.width())
+                     .arg(rect.height())
+                     .arg(screens.at(i)->devicePixelRatio())
+                     .arg(nsecs.at(i) / 1e6, 0, 'f', 1);
+    }
+
+    QImage desktop(nativeGeometry.size(), QImage::Format_RGB32);
+    desktop.fill(Qt::black);
+    QPainter painter(&desktop);
+    for (int i = 0; i < images.size(); ++i) {
+        painter.drawImage(nativeRects.at(i).topLeft() -
+                            nativeGeometry.topLeft(),
+                          images.at(i));
+    }
+    painter.end();
+
+    AbstractLogger::info(AbstractLogger::Stderr)
+      << tr("Screen grab took %1 ms: %2")
+           .arg(total.nsecsElapsed() / 1e6, 0, 'f', 1)
+           .arg(timings.join(QStringLiteral(", ")));
+
+    QPixmap p(QPixmap::fromImage(std::move(desktop)));
+    QScreen* screen = qApp->screenAt(QCursor::pos());
+    p.setDevicePixelRatio(screen->devicePixelRatio());
+    return p;
+}
+
 QRect ScreenGrabber::screenGeometry(QScreen* screen)
 {
     QRect geometry;
@@ -236,21 +424,44 @@ QRect ScreenGrabber::screenGeometry(QScreen* screen)
     return geometry;
 }
 
-QPixmap ScreenGrabber::grabScreen(QScreen* screen, bool& ok)
+QFuture<QPixmap> ScreenGrabber::grabScreen(QScreen* screen)
 {
-    QPixmap p;
     QRect geometry = screenGeometry(screen);
     if (m_info.waylandDetected()) {
-        p = grabEntireDesktop(ok);
-        if (ok) {
-            return p.copy(geometry);
+        return grabEntireDesktop().then(qApp, [geometry](const QPixmap& p) {
+            return p.isNull() ? p : p.copy(geometry);
+        });
+    }
+    return finishedGrab(screen->grabWindow(
+      0, geometry.x(), geometry.y(), geometry.width(), geometry.height()));
+}
+
+/**
+ * @brief Grab a region of the desktop, in native pixels, as an image.
+ *
+ * Meant for repeated grabs. On X11 the MIT-SHM grabber reads the region
+ * straight into its segment, which the returned image shares and which is
+ * overwritten by the next grab. Every other backend grabs the whole desktop
+ * and crops it. A null region means the whole desktop.
+ */
+QFuture<QImage> ScreenGrabber::grabDesktopRegion(const QRect& region)
+{
+#if defined(USE_XCB_SHM)
+    XcbShmGrabber* shmGrabber = XcbShmGrabber::instance();
+    if (!m_info.waylandDetected() && shmGrabber->isAvailable() &&
+        !ConfigHandler().grabScreensSeparately()) {
+        QImage image = shmGrabber->grab(
+          region.isNull() ? shmGrabber->rootGeometry() : region);
+        if (!image.isNull()) {
+            return finishedGrab(image);
         }
-    } else {
-        ok = true;
-        return screen->grabWindow(
-          0, geometry.x(), geometry.y(), geometry.width(), geometry.height());
     }
-    return p;
+#endif
+    return grabEntireDesktop().then(qApp, [region](const QPixmap& p) {
+        QImage image = region.isNull() ? p.toImage() : p.copy(region).toImage();
+        image.setDevicePixelRatio(1);
+        return image;
+    });
 }
 
 QRect ScreenGrabber::desktopGeometry()
@@ -4,7 +4,9 @@
 #pragma once
 
 #include "src/utils/desktopinfo.h"
+#include <QFuture>
 #include <QObject>
+#include <QPixmap>
 #include <QScreen>
 
 class ScreenGrabber : public QObject
@@ -12,14 +14,20 @@ class ScreenGrabber : public QObject
     Q_OBJECT
 public:
     explicit ScreenGrabber(QObject* parent = nullptr);
-    QPixmap grabEntireDesktop(bool& ok);
+    // The futures always finish, with a null pixmap when the grab failed.
+    // They do not depend on the grabber, which can be a temporary.
+    QFuture<QPixmap> grabEntireDesktop();
+    QFuture<QPixmap> grabScreen(QScreen* screenNumber);
+    QFuture<QImage> grabDesktopRegion(const QRect& region);
+    QPixmap grabScreensSeparately(bool& ok);
     QRect screenGeometry(QScreen* screen);
-    QPixmap grabScreen(QScreen* screenNumber, bool& ok);
-    void freeDesktopPortal(bool& ok, QPixmap& res);
+    QFuture<QPixmap> freeDesktopPortal();
     void generalGrimScreenshot(bool& ok, QPixmap& res);
     QRect desktopGeometry();
     QRect logicalDesktopGeometry();
 
 private:
+    QPixmap grabNativeDesktop(bool& ok);
+
     DesktopInfo m_info;
 };
@@ -8,6 +8,7 @@
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/globalvalues.h"
+#include "src/utils/savedcaptures.h"
 #include "utils/desktopinfo.h"
 
 #include <QByteArray>
@@ -34,6 +35,39 @@
 #include "src/widgets/capture/capturewidget.h"
 #endif
 
+namespace {
+
+// Write `capture` to `file`, or link the file an identical capture was saved
+// to before
+bool writeCapture(const QPixmap& capture, QFile& file)
+{
+    ConfigHandler config;
+    QString suffix = QFileInfo(file.fileName()).suffix().toLower();
+    int quality =
+      suffix == "jpg" || suffix == "jpeg" ? config.jpegQuality() : -1;
+    if (!config.linkDuplicateSaves() || file.exists()) {
+        file.open(QIODevice::WriteOnly);
+        return capture.save(&file, nullptr, quality);
+    }
+
+    SavedCaptures saved;
+    QByteArray key = SavedCaptures::key(capture.toImage(), suffix, quality);
+    QString original = saved.find(key);
+    if (!original.isEmpty() &&
+        SavedCaptures::link(original, file.fileName())) {
+        return true;
+    }
+    file.open(QIODevice::WriteOnly);
+    bool okay = capture.save(&file, nullptr, quality);
+    file.close();
+    if (okay) {
+        saved.add(key, file.fileName());
+    }
+    return okay;
+}
+
+} // unnamed namespace
+
 bool saveToFilesystem(const QPixmap& capture,
                       const QString& path,
                       const QString& messagePrefix)
@@ -41,16 +75,7 @@ bool saveToFilesystem(const QPixmap& capture,
     QString completePath = FileNameHandler().properScreenshotPath(
       path, ConfigHandler().saveAsFileExtension());
     QFile file{ completePath };
-    file.open(QIODevice::WriteOnly);
-
-    bool okay;
-    QString saveExtension;
-    saveExtension = QFileInfo(completePath).suffix().toLower();
-    if (saveExtension == "jpg" || saveExtension == "jpeg") {
-        okay = capture.save(&file, nullptr, ConfigHandler().jpegQuality());
-    } else {
-        okay = capture.save(&file);
-    }
+    bool okay = writeCapture(capture, file);
 
     QString saveMessage = messagePrefix;
     QString notificationPath = completePath;
@@ -248,15 +273,7 @@ bool saveToFilesystemGUI(const QPixmap& capture)
     }
 
     QFile file{ savePath };
-    file.open(QIODevice::WriteOnly);
-
-    QString saveExtension;
-    saveExtension = QFileInfo(savePath).suffix().toLower();
-    if (saveExtension == "jpg" || saveExtension == "jpeg") {
-        okay = capture.save(&file, nullptr, ConfigHandler().jpegQuality());
-    } else {
-        okay = capture.save(&file);
-    }
+    okay = writeCapture(capture, file);
 
     if (okay) {
         // Don't use QDir::separator() here, as Qt internally always uses '/'
@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "scrollstitcher.h"
+#include <QHash>
+#include <QMultiHash>
+#include <algorithm>
+#include <cstring>
+
+// Rows hashed together into the windows that are matched between frames
+#define HASH_WINDOW_ROWS 8
+// Windows found more often than this in a frame, like blank areas, don't vote
+#define MAX_WINDOW_MATCHES 4
+// Offsets with the most votes that are checked pixel by pixel
+#define MAX_OFFSET_CANDIDATES 8
+// Rows the two frames must share to trust an offset
+#define MIN_OVERLAP_ROWS 16
+
+namespace {
+
+const quint64 WINDOW_HASH_BASE = 1099511628211ULL;
+
+// Rolling hashes of every HASH_WINDOW_ROWS rows in [top, end)
+QVector<quint64> windowHashes(const QVector<quint64>& rows, int top, int end)
+{
+    QVector<quint64> windows;
+    if (end - top < HASH_WINDOW_ROWS) {
+        return windows;
+    }
+    quint64 highest = 1;
+    for (int i = 1; i < HASH_WINDOW_ROWS; ++i) {
+        highest *= WINDOW_HASH_BASE;
+    }
+    quint64 hash = 0;
+    for (int i = top; i < top + HASH_WINDOW_ROWS; ++i) {
+        hash = hash * WINDOW_HASH_BASE + rows.at(i);
+    }
+    windows.reserve(end - top - HASH_WINDOW_ROWS + 1);
+    windows << hash;
+    for (int i = top + HASH_WINDOW_ROWS; i < end; ++i) {
+        hash = (hash - rows.at(i - HASH_WINDOW_ROWS) * highest) *
+                 WINDOW_HASH_BASE +
+               rows.at(i);
+        windows << hash;
+    }
+    return windows;
+}
+
+} // unnamed namespace
+
+/**
+ * @brief Add the next capture of the scrolled region.
+ *
+ * The first frame is taken whole. The following ones must have its size and
+ * are only appended when the region was scrolled down and still overlaps the
+ * previous frame.
+ */
+ScrollStitcher::FrameResult ScrollStitcher::addFrame(const QImage& frame)
+{
+    if (frame.isNull() || frame.depth() % 8 != 0) {
+        return INVALID_FRAME;
+    }
+    QImage current = frame;
+    if (!m_previous.isNull()) {
+        if (current.size() != m_previous.size()) {
+            return INVALID_FRAME;
+        }
+        if (current.format() != m_previous.format()) {
+            current = current.convertToFormat(m_previous.format());
+        }
+    }
+    QVector<quint64> hashes = rowHashes(current);
+
+    if (m_previous.isNull()) {
+        appendRows(current, 0, current.height());
+        m_previous = current;
+        m_previousHashes = hashes;
+        m_lastOffset = 0;
+        return APPENDED;
+    }
+
+    const int h = current.height();
+    int top = 0;
+    while (top < h && hashes.at(top) == m_previousHashes.at(top) &&
+           rowsEqual(current, top, top)) {
+        ++top;
+    }
+    if (top == h) {
+        return UNCHANGED;
+    }
+    int end = h;
+    while (end > top && hashes.at(end - 1) == m_previousHashes.at(end - 1) &&
+           rowsEqual(current, end - 1, end - 1)) {
+        --end;
+    }
+
+    int offset = findOffset(current, hashes, top, end);
+    if (offset <= 0) {
+        return NO_MATCH;
+    }
+
+    // The stitched image ends with the previous frame. Its bottom rows are
+    // the same in this one, below the rows that scrolled into view.
+    dropRows(h - end);
+    appendRows(current, end - offset, h - end + offset);
+    m_previous = current;
+    m_previousHashes = hashes;
+    m_lastOffset = offset;
+    return APPENDED;
+}
+
+// Rows scrolled into view by the last appended frame
+int ScrollStitcher::lastOffset() const
+{
+    return m_lastOffset;
+}
+
+int ScrollStitcher::height() const
+{
+    return m_height;
+}
+
+bool ScrollStitcher::isEmpty() const
+{
+    return m_strips.isEmpty();
+}
+
+QImage ScrollStitcher::result() const
+{
+    if (m_strips.isEmpty()) {
+        return {};
+    }
+    const QImage& first = m_strips.first().image;
+    QImage image(first.width(), m_height, first.format());
+    const size_t length =
+      static_cast<size_t>(first.width()) * (first.depth() / 8);
+    int y = 0;
+    for (const Strip& strip : m_strips) {
+        for (int i = 0; i < strip.rows; ++i) {
+            std::memcpy(
+              image.scanLine(y++), strip.image.constScanLine(i), length);
+        }
+    }
+    return image;
+}
+
+void ScrollStitcher::clear()
+{
+    m_previous = QImage();
+    m_previousHashes.clear();
+    m_strips.clear();
+    m_height = 0;
+    m_lastOffset = 0;
+}
+
+QVector<quint64> ScrollStitcher::rowHashes(const QImage& frame)
+{
+    const size_t length =
+      static_cast<size_t>(frame.width()) * (frame.depth() / 8);
+    QVector<quint64> hashes(frame.height());
+    for (int y = 0; y < frame.height(); ++y) {
+        hashes[y] = qHashBits(frame.constScanLine(y), length);
+    }
+    return hashes;
+}
+
+bool ScrollStitcher::rowsEqual(const QImage& frame,
+                               int row,
+                               int previousRow) const
+{
+    const size_t length =
+      static_cast<size_t>(frame.width()) * (frame.depth() / 8);
+    return std::memcmp(frame.constScanLine(row),
+                       m_previous.constScanLine(previousRow),
+                       length) == 0;
+}
+
+/**
+ * @brief Find how many rows the region between `top` and `end` scrolled.
+ *
+ * Every window of the new frame that is rare enough in the previous one
+ * votes for the offset between their positions. The offsets with the most
+ * votes are then checked on the whole overlap.
+ * @return the offset, or -1 if the frames don't overlap
+ */
+int ScrollStitcher::findOffset(const QImage& frame,
+                               const QVector<quint64>& hashes,
+                               int top,
+                               int end) const
+{
+    if (end - top < MIN_OVERLAP_ROWS + 1) {
+        return -1;
+    }
+    QVector<quint64> previousWindows =
+      windowHashes(m_previousHashes, top, end);
+    QVector<quint64> windows = windowHashes(hashes, top, end);
+
+    QMultiHash<quint64, int> positions;
+    positions.reserve(previousWindows.size());
+    for (int i = 0; i < previousWindows.size(); ++i) {
+        positions.insert(previousWindows.at(i), i);
+    }
+
+    QHash<int, int> votes;
+    const int maxOffset = end - top - MIN_OVERLAP_ROWS;
+    for (int i = 0; i < windows.size(); ++i) {
+        auto range = positions.equal_range(windows.at(i));
+        if (std::distance(range.first, range.second) > MAX_WINDOW_MATCHES) {
+            continue;
+        }
+        for (auto it = range.first; it != range.second; ++it) {
+            int offset = it.value() - i;
+            if (offset > 0 && offset <= maxOffset) {
+                ++votes[offset];
+            }
+        }
+    }
+
+    QVector<std::pair<int, int>> candidates;
+    candidates.reserve(votes.size());
+    for (auto it = votes.cbegin(); it != votes.cend(); ++it) {
+        candidates.append({ it.value(), it.key() });
+    }
+    // Most votes first, then the smallest scroll
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                  return a.first != b.first ? a.first > b.first
+                                            : a.second < b.second;
+              });
+    const int checked = qMin(static_cast<int>(candidates.size()),
+                             MAX_OFFSET_CANDIDATES);
+    for (int i = 0; i < checked; ++i) {
+        int offset = candidates.at(i).second;
+        if (isOffsetValid(frame, hashes, top, end, offset)) {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+bool ScrollStitcher::isOffsetValid(const QImage& frame,
+                                   const QVector<quint64>& hashes,
+                                   int top,
+                                   int end,
+                                   int offset) const
+{
+    for (int y = top; y < end - offset; ++y) {
+        if (hashes.at(y) != m_previousHashes.at(y + offset)) {
+            return false;
+        }
+    }
+    for (int y = top; y < end - offset; ++y) {
+        if (!rowsEqual(frame, y, y + offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ScrollStitcher::appendRows(const QImage& frame, int first, int count)
+{
+    if (count <= 0) {
+        return;
+    }
+    m_strips.append({ frame.copy(0, first, frame.width(), count), count });
+    m_height += count;
+}
+
+void ScrollStitcher::dropRows(int count)
+{
+    m_height -= count;
+    while (count > 0 && !m_strips.isEmpty()) {
+        Strip& last = m_strips.last();
+        int dropped = qMin(count, last.rows);
+        last.rows -= dropped;
+        count -= dropped;
+        if (last.rows == 0) {
+            m_strips.removeLast();
+        }
+    }
+}
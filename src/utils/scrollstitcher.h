@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QVector>
+
+// Joins consecutive captures of a region that is scrolled down into one tall
+// image. Each frame is registered against the previous one: the rows that
+// stay in place at the top and the bottom, like a toolbar or a status bar, are
+// set aside, and the offset of the rows in between is found by matching
+// rolling hashes of windows of rows, then checked pixel by pixel. Only the
+// rows that scrolled into view are copied, into strips joined by result().
+class ScrollStitcher
+{
+public:
+    enum FrameResult
+    {
+        APPENDED,
+        UNCHANGED,
+        NO_MATCH,
+        INVALID_FRAME,
+    };
+
+    // The frame is kept until the next one is added, so it must own its
+    // pixels
+    FrameResult addFrame(const QImage& frame);
+    int lastOffset() const;
+    int height() const;
+    bool isEmpty() const;
+    QImage result() const;
+    void clear();
+
+private:
+    struct Strip
+    {
+        QImage image;
+        int rows;
+    };
+
+    static QVector<quint64> rowHashes(const QImage& frame);
+    bool rowsEqual(const QImage& frame, int row, int previousRow) const;
+    int findOffset(const QImage& frame,
+                   const QVector<quint64>& hashes,
+                   int top,
+                   int end) const;
+    bool isOffsetValid(const QImage& frame,
+                       const QVector<quint64>& hashes,
+                       int top,
+                       int end,
+                       int offset) const;
+    void appendRows(const QImage& frame, int first, int count);
+    void dropRows(int count);
+
+    QImage m_previous;
+    QVector<quint64> m_previousHashes;
+    QVector<Strip> m_strips;
+    int m_height{ 0 };
+    int m_lastOffset{ 0 };
+};
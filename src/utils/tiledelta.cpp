@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "tiledelta.h"
+#include <cstring>
+
+TileDelta::TileDelta(int tileSize, int atlasColumns)
+  : m_tileSize(qMax(1, tileSize))
+  , m_atlasColumns(qMax(1, atlasColumns))
+{}
+
+int TileDelta::tileSize() const
+{
+    return m_tileSize;
+}
+
+int TileDelta::atlasColumns() const
+{
+    return m_atlasColumns;
+}
+
+int TileDelta::tileCount(const QSize& frameSize) const
+{
+    int columns = (frameSize.width() + m_tileSize - 1) / m_tileSize;
+    int rows = (frameSize.height() + m_tileSize - 1) / m_tileSize;
+    return columns * rows;
+}
+
+/**
+ * @brief List the tiles of `current` that differ from `previous`.
+ *
+ * Rows are compared with memcmp, which stops at the first difference, so a
+ * static tile costs one pass over its pixels and a changed one usually much
+ * less. Every tile is listed when the images can't be compared.
+ */
+QVector<QPoint> TileDelta::changedTiles(const QImage& previous,
+                                        const QImage& current) const
+{
+    const QSize size = current.size();
+    const int columns = (size.width() + m_tileSize - 1) / m_tileSize;
+    const int rows = (size.height() + m_tileSize - 1) / m_tileSize;
+    const bool comparable = previous.size() == size &&
+                            previous.format() == current.format() &&
+                            current.depth() % 8 == 0;
+    const int bytesPerPixel = current.depth() / 8;
+
+    QVector<QPoint> tiles;
+    for (int ty = 0; ty < rows; ++ty) {
+        for (int tx = 0; tx < columns; ++tx) {
+            QPoint tile(tx, ty);
+            if (!comparable) {
+                tiles << tile;
+                continue;
+            }
+            QRect r = tileRect(tile, size);
+            const qsizetype offset =
+              static_cast<qsizetype>(r.x()) * bytesPerPixel;
+            const size_t length =
+              static_cast<size_t>(r.width()) * bytesPerPixel;
+            for (int y = r.top(); y <= r.bottom(); ++y) {
+                if (std::memcmp(previous.constScanLine(y) + offset,
+                                current.constScanLine(y) + offset,
+                                length) != 0) {
+                    tiles << tile;
+                    break;
+                }
+            }
+        }
+    }
+    return tiles;
+}
+
+QImage TileDelta::pack(const QImage& frame, const QVector<QPoint>& tiles) const
+{
+    if (tiles.isEmpty()) {
+        return {};
+    }
+    const int columns = qMin(m_atlasColumns, static_cast<int>(tiles.size()));
+    const int rows =
+      (static_cast<int>(tiles.size()) + m_atlasColumns - 1) / m_atlasColumns;
+    QImage atlas(columns * m_tileSize, rows * m_tileSize, frame.format());
+    atlas.fill(0);
+    for (int i = 0; i < tiles.size(); ++i) {
+        copyPixels(
+          frame, tileRect(tiles.at(i), frame.size()), atlas, atlasPosition(i));
+    }
+    return atlas;
+}
+
+/**
+ * @brief Copy the tiles of `atlas` onto `frame`.
+ * @return false if a tile lies outside of the frame or of the atlas
+ */
+bool TileDelta::apply(QImage& frame,
+                      const QImage& atlas,
+                      const QVector<QPoint>& tiles) const
+{
+    QImage source = atlas.format() == frame.format()
+                      ? atlas
+                      : atlas.convertToFormat(frame.format());
+    const QRect atlasRect = source.rect();
+    for (int i = 0; i < tiles.size(); ++i) {
+        QRect target = tileRect(tiles.at(i), frame.size());
+        QRect sourceRect(atlasPosition(i), target.size());
+        if (target.isEmpty() || !atlasRect.contains(sourceRect)) {
+            return false;
+        }
+        copyPixels(source, sourceRect, frame, target.topLeft());
+    }
+    return true;
+}
+
+QRect TileDelta::tileRect(const QPoint& tile, const QSize& frameSize) const
+{
+    return QRect(tile * m_tileSize, QSize(m_tileSize, m_tileSize))
+      .intersected(QRect(QPoint(0, 0), frameSize));
+}
+
+QPoint TileDelta::atlasPosition(int index) const
+{
+    return QPoint(index % m_atlasColumns, index / m_atlasColumns) * m_tileSize;
+}
+
+void TileDelta::copyPixels(const QImage& source,
+                           const QRect& sourceRect,
+                           QImage& target,
+                           const QPoint& targetPos) const
+{
+    const int bytesPerPixel = source.depth() / 8;
+    const size_t length =
+      static_cast<size_t>(sourceRect.width()) * bytesPerPixel;
+    for (int y = 0; y < sourceRect.height(); ++y) {
+        std::memcpy(target.scanLine(targetPos.y() + y) +
+                      static_cast<qsizetype>(targetPos.x()) * bytesPerPixel,
+                    source.constScanLine(sourceRect.y() + y) +
+                      static_cast<qsizetype>(sourceRect.x()) * bytesPerPixel,
+                    length);
+    }
+}
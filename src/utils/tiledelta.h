@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QPoint>
+#include <QVector>
+
+// Fixed size tiles that differ between two captures of the same region. The
+// changed tiles of a frame are packed, in the order they are listed, into an
+// atlas image that is a row of `atlasColumns` tiles wide. Applying the atlas
+// onto the previous frame gives back the new one.
+class TileDelta
+{
+public:
+    explicit TileDelta(int tileSize = 64, int atlasColumns = 16);
+
+    int tileSize() const;
+    int atlasColumns() const;
+    int tileCount(const QSize& frameSize) const;
+
+    QVector<QPoint> changedTiles(const QImage& previous,
+                                 const QImage& current) const;
+    QImage pack(const QImage& frame, const QVector<QPoint>& tiles) const;
+    bool apply(QImage& frame,
+               const QImage& atlas,
+               const QVector<QPoint>& tiles) const;
+
+private:
+    QRect tileRect(const QPoint& tile, const QSize& frameSize) const;
+    QPoint atlasPosition(int index) const;
+    void copyPixels(const QImage& source,
+                    const QRect& sourceRect,
+                    QImage& target,
+                    const QPoint& targetPos) const;
+
+    int m_tileSize;
+    int m_atlasColumns;
+};
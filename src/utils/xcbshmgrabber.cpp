@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "xcbshmgrabber.h"
+#include <QGuiApplication>
+#include <QSysInfo>
+#include <cstdlib>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <xcb/shm.h>
+#include <xcb/xcb.h>
+
+XcbShmGrabber* XcbShmGrabber::instance()
+{
+    static XcbShmGrabber grabber;
+    return &grabber;
+}
+
+XcbShmGrabber::XcbShmGrabber()
+{
+#if QT_CONFIG(xcb)
+    auto* x11 = qApp->nativeInterface<QNativeInterface::QX11Application>();
+    if (x11 == nullptr) {
+        return;
+    }
+    m_connection = x11->connection();
+#else
+    return;
+#endif
+
+    // Only the common 32 bits per pixel layout maps onto QImage without a
+    // conversion, anything else goes through Qt
+    const xcb_setup_t* setup = xcb_get_setup(m_connection);
+    // The screen of DISPLAY, the one Qt connected to, not always the first
+    int screenNumber = 0;
+    xcb_parse_display(nullptr, nullptr, nullptr, &screenNumber);
+    auto roots = xcb_setup_roots_iterator(setup);
+    for (; roots.rem > 1 && screenNumber > 0; --screenNumber) {
+        xcb_screen_next(&roots);
+    }
+    xcb_screen_t* screen = roots.data;
+    if (screen == nullptr ||
+        (screen->root_depth != 24 && screen->root_depth != 32) ||
+        setup->image_byte_order != XCB_IMAGE_ORDER_LSB_FIRST ||
+        QSysInfo::ByteOrder != QSysInfo::LittleEndian) {
+        return;
+    }
+    bool format32 = false;
+    auto formats = xcb_setup_pixmap_formats_iterator(setup);
+    for (; formats.rem > 0; xcb_format_next(&formats)) {
+        if (formats.data->depth == screen->root_depth) {
+            format32 = formats.data->bits_per_pixel == 32;
+        }
+    }
+    if (!format32) {
+        return;
+    }
+
+    xcb_shm_query_version_reply_t* version = xcb_shm_query_version_reply(
+      m_connection, xcb_shm_query_version(m_connection), nullptr);
+    if (version == nullptr) {
+        return;
+    }
+    free(version);
+
+    m_root = screen->root;
+    m_available = true;
+}
+
+XcbShmGrabber::~XcbShmGrabber()
+{
+    // The X connection is already gone when static objects are destroyed,
+    // the server drops its side of the segment together with the connection
+    if (m_data != nullptr) {
+        shmdt(m_data);
+    }
+}
+
+bool XcbShmGrabber::isAvailable() const
+{
+    return m_available;
+}
+
+// Asked to the server every time: monitors are added, removed or change
+// resolution while the daemon runs
+QRect XcbShmGrabber::rootGeometry() const
+{
+    if (!m_available) {
+        return {};
+    }
+    xcb_get_geometry_reply_t* geometry = xcb_get_geometry_reply(
+      m_connection, xcb_get_geometry(m_connection, m_root), nullptr);
+    if (geometry == nullptr) {
+        return {};
+    }
+    QRect rect(0, 0, geometry->width, geometry->height);
+    free(geometry);
+    return rect;
+}
+
+QImage XcbShmGrabber::grab(const QRect& rect)
+{
+    if (!m_available) {
+        return {};
+    }
+    QRect r = rect.intersected(rootGeometry());
+    if (r.isEmpty()) {
+        return {};
+    }
+    const qsizetype bytesPerLine = r.width() * 4;
+    if (!reserve(bytesPerLine * r.height())) {
+        return {};
+    }
+
+    xcb_generic_error_t* error = nullptr;
+    xcb_shm_get_image_cookie_t cookie =
+      xcb_shm_get_image(m_connection,
+                        m_root,
+                        static_cast<int16_t>(r.x()),
+                        static_cast<int16_t>(r.y()),
+                        static_cast<uint16_t>(r.width()),
+                        static_cast<uint16_t>(r.height()),
+                        ~0u,
+                        XCB_IMAGE_FORMAT_Z_PIXMAP,
+                        m_segment,
+                        0);
+    xcb_shm_get_image_reply_t* reply =
+      xcb_shm_get_image_reply(m_connection, cookie, &error);
+    if (reply == nullptr) {
+        free(error);
+        return {};
+    }
+    free(reply);
+
+    // The server leaves the pad byte of depth 24 pixels undefined, often 0,
+    // where QImage::Format_RGB32 wants 0xff
+    auto* pixels = reinterpret_cast<quint32*>(m_data);
+    const qsizetype count = static_cast<qsizetype>(r.width()) * r.height();
+    for (qsizetype i = 0; i < count; ++i) {
+        pixels[i] |= 0xff000000;
+    }
+    return QImage(
+      m_data, r.width(), r.height(), bytesPerLine, QImage::Format_RGB32);
+}
+
+bool XcbShmGrabber::reserve(qsizetype size)
+{
+    if (size <= m_size) {
+        return true;
+    }
+    release();
+
+    int shmId = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (shmId < 0) {
+        m_available = false;
+        return false;
+    }
+    void* data = shmat(shmId, nullptr, 0);
+    if (data == reinterpret_cast<void*>(-1)) {
+        shmctl(shmId, IPC_RMID, nullptr);
+        m_available = false;
+        return false;
+    }
+
+    quint32 segment = xcb_generate_id(m_connection);
+    xcb_generic_error_t* error = xcb_request_check(
+      m_connection, xcb_shm_attach_checked(m_connection, segment, shmId, 0));
+    // Once attached on both sides the segment is freed with its last user
+    shmctl(shmId, IPC_RMID, nullptr);
+    if (error != nullptr) {
+        // Typically a remote display that cannot see our memory
+        free(error);
+        shmdt(data);
+        m_available = false;
+        return false;
+    }
+
+    m_segment = segment;
+    m_data = static_cast<uchar*>(data);
+    m_size = size;
+    return true;
+}
+
+void XcbShmGrabber::release()
+{
+    if (m_data == nullptr) {
+        return;
+    }
+    xcb_shm_detach(m_connection, m_segment);
+    shmdt(m_data);
+    m_data = nullptr;
+    m_size = 0;
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QRect>
+
+struct xcb_connection_t;
+
+/**
+ * @brief Grabs the X11 root window through the MIT-SHM extension.
+ *
+ * The X server writes the pixels straight into a shared memory segment that is
+ * kept between grabs, instead of sending them over the socket like
+ * XGetImage does. Remote displays and servers without the extension are
+ * reported as unavailable so the caller can fall back to QScreen::grabWindow.
+ */
+class XcbShmGrabber
+{
+public:
+    static XcbShmGrabber* instance();
+
+    bool isAvailable() const;
+    QRect rootGeometry() const;
+
+    // The returned image points into the shared segment and is only valid
+    // until the next grab, copy it to keep it around
+    QImage grab(const QRect& rect);
+
+private:
+    XcbShmGrabber();
+    ~XcbShmGrabber();
+
+    bool reserve(qsizetype size);
+    void release();
+
+    xcb_connection_t* m_connection{ nullptr };
+    quint32 m_root{ 0 };
+    quint32 m_segment{ 0 };
+    uchar* m_data{ nullptr };
+    qsizetype m_size{ 0 };
+    bool m_available{ false };
+};
@@ -15,7 +15,6 @@ void CaptureToolObjects::append(const QPointer<CaptureTool>& captureTool)
 {
     if (!captureTool.isNull()) {
         m_captureToolObjects.append(captureTool->copy(captureTool->parent()));
-        m_imageCache.clear();
     }
 }
 
@@ -26,7 +25,6 @@ void CaptureToolObjects::insert(int index,
         index <= m_captureToolObjects.size()) {
         m_captureToolObjects.insert(index,
                                     captureTool->copy(captureTool->parent()));
-        m_imageCache.clear();
     }
 }
 
@@ -57,7 +55,6 @@ void CaptureToolObjects::removeAt(int index)
 {
     if (index >= 0 && index < m_captureToolObjects.size()) {
         m_captureToolObjects.removeAt(index);
-        m_imageCache.clear();
     }
 }
 
@@ -86,29 +83,22 @@ int CaptureToolObjects::findWithRadius(QPainter& painter,
                                        const QPoint& pos,
                                        int radius)
 {
-    int index = m_captureToolObjects.size() - 1;
-    bool useCache = true;
-    m_imageCache.clear();
-    if (m_imageCache.size() != m_captureToolObjects.size() && index >= 0) {
-        // TODO - is not optimal and cache will be used just after first tool
-        // object selecting
-        m_imageCache.clear();
-        useCache = false;
+    // Only pixels around the mouse position are inspected, so just this area
+    // is read back instead of converting the whole search pixmap
+    const int maxRadius = radius + SEARCH_RADIUS_TEXT_HANDICAP;
+    const QRect searchArea =
+      QRect(pos - QPoint(maxRadius, maxRadius),
+            pos + QPoint(maxRadius, maxRadius))
+        .intersected(pixmap.rect());
+    if (searchArea.isEmpty()) {
+        return -1;
     }
-    for (; index >= 0; --index) {
+
+    for (int index = m_captureToolObjects.size() - 1; index >= 0; --index) {
         int currentRadius = radius;
-        QImage image;
         auto toolItem = m_captureToolObjects.at(index);
-        if (useCache) {
-            image = m_imageCache.at(index);
-        } else {
-            // create transparent image in memory and draw toolItem on it
-            toolItem->drawSearchArea(painter, pixmap);
-
-            // get color at mouse clicked position in area +/- currentRadius
-            image = pixmap.toImage();
-            m_imageCache.insert(0, image);
-        }
+        // draw toolItem on the transparent pixmap
+        toolItem->drawSearchArea(painter, pixmap);
 
         if (toolItem->type() == CaptureTool::TYPE_TEXT) {
             if (currentRadius > SEARCH_RADIUS_NEAR) {
@@ -123,12 +113,15 @@ int CaptureToolObjects::findWithRadius(QPainter& painter,
             currentRadius += SEARCH_RADIUS_TEXT_HANDICAP;
         }
 
+        // get color at mouse clicked position in area +/- currentRadius
+        QImage image = pixmap.copy(searchArea).toImage();
+
         for (int x = pos.x() - currentRadius; x <= pos.x() + currentRadius;
              ++x) {
             for (int y = pos.y() - currentRadius; y <= pos.y() + currentRadius;
                  ++y) {
-                QRgb rgb = image.pixel(x, y);
-                if (rgb != 0) {
+                const QPoint pixel(x - searchArea.left(), y - searchArea.top());
+                if (image.valid(pixel) && image.pixel(pixel) != 0) {
                     // object was found, return it index (layer index)
                     return index;
                 }
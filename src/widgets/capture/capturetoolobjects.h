@@ -30,7 +30,6 @@ private:
 
     // class members
     QList<QPointer<CaptureTool>> m_captureToolObjects;
-    QVector<QImage> m_imageCache;
 };
 
 #endif // FLAMESHOT_CAPTURETOOLOBJECTS_H
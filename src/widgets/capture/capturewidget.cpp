@@ -18,7 +18,6 @@
 #include "src/core/qguiappcurrentscreen.h"
 #include "src/tools/toolfactory.h"
 #include "src/utils/colorutils.h"
-#include "src/utils/screengrabber.h"
 #include "src/utils/screenshotsaver.h"
 #include "src/utils/systemnotification.h"
 #include "src/widgets/capture/colorpicker.h"
@@ -54,6 +53,7 @@
 // enableSaveWindow
 
 CaptureWidget::CaptureWidget(const CaptureRequest& req,
+                             const QPixmap& screenshot,
                              bool fullScreen,
                              QWidget* parent)
   : QWidget(parent)
@@ -109,16 +109,9 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
     // Top left of the whole set of screens
     QPoint topLeft(0, 0);
 #endif
+    m_context.screenshot = screenshot;
+    m_context.origScreenshot = screenshot;
     if (fullScreen) {
-        // Grab Screenshot
-        bool ok = true;
-        m_context.screenshot = ScreenGrabber().grabEntireDesktop(ok);
-        if (!ok) {
-            AbstractLogger::error() << tr("Unable to capture screen");
-            this->close();
-        }
-        m_context.origScreenshot = m_context.screenshot;
-
 #if defined(Q_OS_WIN)
 // Call cmake with -DFLAMESHOT_DEBUG_CAPTURE=ON to enable easier debugging
 #if !defined(FLAMESHOT_DEBUG_CAPTURE)
@@ -460,6 +453,7 @@ bool CaptureWidget::commitCurrentTool()
 {
     if (m_activeTool) {
         processPixmapWithTool(&m_context.screenshot, m_activeTool);
+        m_dirtyTiles.add(paddedUpdateRect(m_activeTool->boundingRect()));
         if (m_activeTool->isValid() && !m_activeTool->editMode() &&
             m_toolWidget) {
             pushToolToStack();
@@ -661,27 +655,7 @@ void CaptureWidget::paintEvent(QPaintEvent* paintEvent)
     }
 
     if (m_displayGrid) {
-        QColor uicolor = ConfigHandler().uiColor();
-        uicolor.setAlpha(100);
-        painter.setPen(uicolor);
-        painter.setBrush(QBrush(uicolor));
-
-        const auto scale{ m_context.screenshot.devicePixelRatio() };
-        auto topLeft = mapToGlobal(m_context.selection.topLeft() / scale);
-        topLeft.rx() -= topLeft.x() % m_gridSize;
-        topLeft.ry() -= topLeft.y() % m_gridSize;
-        topLeft = mapFromGlobal(topLeft);
-
-        const auto step{ m_gridSize / scale };
-        const auto radius{ 1 * scale };
-
-        for (int y = topLeft.y(); y < m_context.selection.bottom() / scale;
-             y += step) {
-            for (int x = topLeft.x(); x < m_context.selection.right() / scale;
-                 x += step) {
-                painter.drawEllipse(x, y, radius, radius);
-            }
-        }
+        drawGrid(&painter);
     }
 
     if (m_activeTool && m_mouseIsClicked) {
@@ -1185,7 +1159,7 @@ void CaptureWidget::initPanel()
             this,
             &CaptureWidget::onMoveCaptureToolDown);
 
-    m_sidePanel = new SidePanelWidget(&m_context.screenshot, this);
+    m_sidePanel = new SidePanelWidget(&m_context, this);
     connect(m_sidePanel,
             &SidePanelWidget::colorChanged,
             this,
@@ -1220,7 +1194,7 @@ void CaptureWidget::initPanel()
     m_panel->pushWidget(m_sidePanel);
 
     // Fill undo/redo/history list widget
-    m_panel->fillCaptureTools(m_captureToolObjects.captureToolObjects());
+    m_panel->updateCaptureTools(m_captureToolObjects.captureToolObjects());
 }
 
 #if !defined(DISABLE_UPDATE_CHECKER)
@@ -1441,6 +1415,7 @@ void CaptureWidget::onToolSizeChanged(int t)
     if (toolItem) {
         // Change thickness
         toolItem->onSizeChanged(t);
+        m_dirtyTiles.add(paddedUpdateRect(toolItem->boundingRect()));
         if (!m_existingObjectIsChanged) {
             m_captureToolObjectsBackup = m_captureToolObjects;
             m_existingObjectIsChanged = true;
@@ -1472,6 +1447,7 @@ void CaptureWidget::setDrawColor(const QColor& c)
         if (toolItem) {
             // Change color
             toolItem->onColorChanged(c);
+            m_dirtyTiles.add(paddedUpdateRect(toolItem->boundingRect()));
             drawToolsData();
         }
     }
@@ -1509,6 +1485,7 @@ void CaptureWidget::onMoveCaptureToolUp(int captureToolIndex)
     m_captureToolObjects.removeAt(captureToolIndex);
     m_captureToolObjects.insert(captureToolIndex - 1, tool);
     updateLayersPanel();
+    drawToolsData();
 }
 
 void CaptureWidget::onMoveCaptureToolDown(int captureToolIndex)
@@ -1519,6 +1496,7 @@ void CaptureWidget::onMoveCaptureToolDown(int captureToolIndex)
     m_captureToolObjects.removeAt(captureToolIndex);
     m_captureToolObjects.insert(captureToolIndex + 1, tool);
     updateLayersPanel();
+    drawToolsData();
 }
 
 void CaptureWidget::selectAll()
@@ -1552,6 +1530,8 @@ void CaptureWidget::removeToolObject(int index)
                 auto circleTool = m_captureToolObjects.at(cnt);
                 if (circleTool->count() >= removedCircleCount) {
                     circleTool->setCount(circleTool->count() - 1);
+                    m_dirtyTiles.add(
+                      paddedUpdateRect(circleTool->boundingRect()));
                 }
             }
         }
@@ -1716,7 +1696,7 @@ void CaptureWidget::updateTool(CaptureTool* tool)
 
 void CaptureWidget::updateLayersPanel()
 {
-    m_panel->fillCaptureTools(m_captureToolObjects.captureToolObjects());
+    m_panel->updateCaptureTools(m_captureToolObjects.captureToolObjects());
 }
 
 void CaptureWidget::pushToolToStack()
@@ -1753,15 +1733,99 @@ void CaptureWidget::pushToolToStack()
 
 void CaptureWidget::drawToolsData(bool drawSelection)
 {
-    // TODO refactor this for performance. The objects should not all be updated
-    // at once every time
-    QPixmap pixmapItem = m_context.origScreenshot;
+    QList<ComposedTool> composed;
     for (const auto& toolItem : m_captureToolObjects.captureToolObjects()) {
-        processPixmapWithTool(&pixmapItem, toolItem);
-        update(paddedUpdateRect(toolItem->boundingRect()));
+        composed << ComposedTool{ toolItem,
+                                  paddedUpdateRect(toolItem->boundingRect()),
+                                  toolItem->editMode() };
+    }
+
+    if (m_composedOrigKey != m_context.origScreenshot.cacheKey()) {
+        m_composedOrigKey = m_context.origScreenshot.cacheKey();
+        m_dirtyTiles.setBounds(QRect(
+          QPoint(0, 0),
+          m_context.origScreenshot.deviceIndependentSize().toSize()));
+        m_dirtyTiles.addAll();
+    } else {
+        // Objects that kept their place in the stack and did not change are
+        // already in the screenshot, everything in between is redrawn
+        auto unchanged = [](const ComposedTool& a, const ComposedTool& b) {
+            return a.tool && a.tool == b.tool && a.rect == b.rect &&
+                   a.editMode == b.editMode;
+        };
+        const int oldSize = m_composedTools.size();
+        const int newSize = composed.size();
+        int prefix = 0;
+        while (prefix < qMin(oldSize, newSize) &&
+               unchanged(m_composedTools.at(prefix), composed.at(prefix))) {
+            ++prefix;
+        }
+        int suffix = 0;
+        while (suffix < qMin(oldSize, newSize) - prefix &&
+               unchanged(m_composedTools.at(oldSize - 1 - suffix),
+                         composed.at(newSize - 1 - suffix))) {
+            ++suffix;
+        }
+        for (int i = prefix; i < oldSize - suffix; ++i) {
+            m_dirtyTiles.add(m_composedTools.at(i).rect);
+        }
+        for (int i = prefix; i < newSize - suffix; ++i) {
+            m_dirtyTiles.add(composed.at(i).rect);
+        }
     }
 
-    m_context.screenshot = pixmapItem;
+    if (composed.isEmpty()) {
+        // Nothing is drawn, share the pixels with the original again
+        m_context.screenshot = m_context.origScreenshot;
+        update(m_dirtyTiles.region());
+        m_dirtyTiles.clear();
+    }
+
+    while (!m_dirtyTiles.isEmpty()) {
+        // Objects are always redrawn as a whole because some of them read
+        // back the pixels they cover, so grow the area until it holds every
+        // object it touches
+        bool grown = true;
+        while (grown) {
+            grown = false;
+            for (const auto& item : composed) {
+                if (m_dirtyTiles.intersects(item.rect) &&
+                    !m_dirtyTiles.contains(item.rect)) {
+                    m_dirtyTiles.add(item.rect);
+                    grown = true;
+                }
+            }
+        }
+        const QRegion region = m_dirtyTiles.region();
+        m_dirtyTiles.clear();
+
+        QPainter painter(&m_context.screenshot);
+        painter.setClipRegion(region);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawPixmap(0, 0, m_context.origScreenshot);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        painter.setRenderHint(QPainter::Antialiasing);
+        for (auto& item : composed) {
+            if (!region.intersects(item.rect)) {
+                continue;
+            }
+            painter.save();
+            item.tool->process(painter, m_context.screenshot);
+            painter.restore();
+            // Some objects (text) only know their final size once drawn
+            QRect drawn = paddedUpdateRect(item.tool->boundingRect());
+            if (drawn != item.rect) {
+                item.rect = drawn;
+                if (!QRegion(drawn).subtracted(region).isEmpty()) {
+                    m_dirtyTiles.add(drawn);
+                }
+            }
+        }
+        painter.end();
+        update(region);
+    }
+
+    m_composedTools = composed;
     if (drawSelection) {
         drawObjectSelection();
     }
@@ -1771,6 +1835,9 @@ void CaptureWidget::drawObjectSelection()
 {
     auto toolItem = activeToolObject();
     if (toolItem && !toolItem->editMode()) {
+        // The outline is drawn into the screenshot, so its area has to be
+        // composited again the next time the objects are drawn
+        m_dirtyTiles.add(paddedUpdateRect(toolItem->boundingRect()));
         QPainter painter(&m_context.screenshot);
         toolItem->drawObjectSelection(painter);
         // TODO move this elsewhere
@@ -1984,6 +2051,53 @@ void CaptureWidget::drawErrorMessage(const QString& msg, QPainter* painter)
     }
 }
 
+void CaptureWidget::drawGrid(QPainter* painter)
+{
+    const qreal scale = m_context.screenshot.devicePixelRatio();
+    const qreal dpr = devicePixelRatioF();
+    QColor gridColor = m_uiColor;
+    gridColor.setAlpha(100);
+
+    // Every grid cell looks the same, so a single cell is rendered once and
+    // tiled over the selection instead of drawing each dot on every paint
+    if (m_gridTile.isNull() || m_gridTileSize != m_gridSize ||
+        m_gridTileColor != gridColor || m_gridTileDpr != dpr ||
+        m_gridTileScale != scale) {
+        // One grid step is m_gridSize / scale logical pixels
+        const qreal step = m_gridSize / scale;
+        const int side = qMax(1, qRound(step * dpr));
+        m_gridTile = QPixmap(side, side);
+        m_gridTile.fill(Qt::transparent);
+
+        QPainter tilePainter(&m_gridTile);
+        tilePainter.scale(dpr, dpr);
+        tilePainter.setPen(gridColor);
+        tilePainter.setBrush(QBrush(gridColor));
+        const int radius = static_cast<int>(1 * scale);
+        tilePainter.drawEllipse(0, 0, radius, radius);
+        tilePainter.end();
+
+        m_gridTileSize = m_gridSize;
+        m_gridTileColor = gridColor;
+        m_gridTileDpr = dpr;
+        m_gridTileScale = scale;
+    }
+
+    // The tile is stored in device pixels, map it back to logical ones
+    QBrush gridBrush(m_gridTile);
+    gridBrush.setTransform(QTransform::fromScale(1 / dpr, 1 / dpr));
+
+    // The grid is anchored to the global origin so that the dots match the
+    // points used by snapToGrid
+    painter->setBrushOrigin(mapFromGlobal(QPoint(0, 0)));
+    const QRect& selection = m_context.selection;
+    painter->fillRect(QRectF(selection.left() / scale,
+                             selection.top() / scale,
+                             selection.width() / scale,
+                             selection.height() / scale),
+                      gridBrush);
+}
+
 void CaptureWidget::drawInactiveRegion(QPainter* painter)
 {
     QColor overlayColor(0, 0, 0, m_opacity);
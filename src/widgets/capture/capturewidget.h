@@ -14,6 +14,7 @@
 #include "buttonhandler.h"
 #include "capturetoolbutton.h"
 #include "capturetoolobjects.h"
+#include "dirtytiles.h"
 #include "src/config/generalconf.h"
 #include "src/tools/capturecontext.h"
 #include "src/tools/capturetool.h"
@@ -41,13 +42,18 @@ class UpdateNotificationWidget;
 #endif
 class UtilityPanel;
 class SidePanelWidget;
+class CaptureWidgetBenchmark;
 
 class CaptureWidget : public QWidget
 {
     Q_OBJECT
+    // Times the private drawing and undo paths, see tests/benchmarks
+    friend class CaptureWidgetBenchmark;
 
 public:
+    // The screenshot is grabbed by the caller, see ScreenGrabber
     explicit CaptureWidget(const CaptureRequest& req,
+                           const QPixmap& screenshot,
                            bool fullScreen = true,
                            QWidget* parent = nullptr);
     ~CaptureWidget();
@@ -145,6 +151,7 @@ private:
     QRect paddedUpdateRect(const QRect& r) const;
     void drawErrorMessage(const QString& msg, QPainter* painter);
     void drawInactiveRegion(QPainter* painter);
+    void drawGrid(QPainter* painter);
     void drawToolsData(bool drawSelection = true);
     void drawObjectSelection();
 
@@ -155,6 +162,14 @@ private:
 
     QPoint snapToGrid(const QPoint& point) const;
 
+    // An object as it was last composited into m_context.screenshot
+    struct ComposedTool
+    {
+        QPointer<CaptureTool> tool;
+        QRect rect;
+        bool editMode;
+    };
+
     ////////////////////////////////////////
     // Class members
 
@@ -218,6 +233,11 @@ private:
 
     QUndoStack m_undoStack;
 
+    // Incremental compositing of the objects into m_context.screenshot
+    QList<ComposedTool> m_composedTools;
+    DirtyTiles m_dirtyTiles;
+    qint64 m_composedOrigKey{ 0 };
+
     bool m_existingObjectIsChanged;
 
     // For start moving after more than X offset
@@ -227,4 +247,10 @@ private:
     // Grid
     bool m_displayGrid{ false };
     int m_gridSize{ 10 };
+    // Cached grid cell, rebuilt only when one of its keys changes
+    QPixmap m_gridTile;
+    int m_gridTileSize{ 0 };
+    QColor m_gridTileColor;
+    qreal m_gridTileDpr{ 0 };
+    qreal m_gridTileScale{ 0 };
 };
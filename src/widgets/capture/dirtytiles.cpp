@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "dirtytiles.h"
+
+DirtyTiles::DirtyTiles(int tileSize)
+  : m_tileSize(tileSize)
+{}
+
+void DirtyTiles::setBounds(const QRect& bounds)
+{
+    m_bounds = bounds;
+    m_region = m_region.intersected(m_bounds);
+}
+
+QRect DirtyTiles::bounds() const
+{
+    return m_bounds;
+}
+
+void DirtyTiles::add(const QRect& rect)
+{
+    QRect tiles = tileAligned(rect);
+    if (!tiles.isEmpty()) {
+        m_region += tiles;
+    }
+}
+
+void DirtyTiles::addAll()
+{
+    m_region = m_bounds;
+}
+
+void DirtyTiles::clear()
+{
+    m_region = QRegion();
+}
+
+bool DirtyTiles::isEmpty() const
+{
+    return m_region.isEmpty();
+}
+
+bool DirtyTiles::intersects(const QRect& rect) const
+{
+    return m_region.intersects(tileAligned(rect));
+}
+
+bool DirtyTiles::contains(const QRect& rect) const
+{
+    return QRegion(tileAligned(rect)).subtracted(m_region).isEmpty();
+}
+
+const QRegion& DirtyTiles::region() const
+{
+    return m_region;
+}
+
+QRect DirtyTiles::tileAligned(const QRect& rect) const
+{
+    QRect r = rect.normalized().intersected(m_bounds);
+    if (r.isEmpty()) {
+        return {};
+    }
+    // Tiles are counted from the top left corner of the bounds
+    int left = (r.left() - m_bounds.left()) / m_tileSize * m_tileSize;
+    int top = (r.top() - m_bounds.top()) / m_tileSize * m_tileSize;
+    int right = (r.right() - m_bounds.left()) / m_tileSize * m_tileSize;
+    int bottom = (r.bottom() - m_bounds.top()) / m_tileSize * m_tileSize;
+    QRect tiles(m_bounds.left() + left,
+                m_bounds.top() + top,
+                right - left + m_tileSize,
+                bottom - top + m_tileSize);
+    return tiles.intersected(m_bounds);
+}
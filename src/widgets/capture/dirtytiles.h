@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QRect>
+#include <QRegion>
+
+// Set of fixed size tiles of the capture overlay that no longer match the
+// composited screenshot. Rectangles are rounded out to whole tiles so the
+// region stays simple no matter how many objects mark it.
+class DirtyTiles
+{
+public:
+    explicit DirtyTiles(int tileSize = 256);
+
+    void setBounds(const QRect& bounds);
+    QRect bounds() const;
+
+    void add(const QRect& rect);
+    void addAll();
+    void clear();
+
+    bool isEmpty() const;
+    bool intersects(const QRect& rect) const;
+    bool contains(const QRect& rect) const;
+    const QRegion& region() const;
+
+private:
+    QRect tileAligned(const QRect& rect) const;
+
+    int m_tileSize;
+    QRect m_bounds;
+    QRegion m_region;
+};
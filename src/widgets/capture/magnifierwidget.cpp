@@ -23,14 +23,34 @@ MagnifierWidget::MagnifierWidget(const QPixmap& p,
     setFixedSize(parent->width(), parent->height());
     setAttribute(Qt::WA_TransparentForMouseEvents);
     m_color.setAlpha(130);
-    // add padding for circular magnifier
-    QImage padded(p.width() + 2 * m_magPixels,
-                  p.height() + 2 * m_magPixels,
-                  QImage::Format_ARGB32);
-    padded.fill(Qt::black);
-    QPainter painter(&padded);
-    painter.drawPixmap(m_magPixels, m_magPixels, p);
-    m_paddedScreenshot.convertFromImage(padded);
+    // the circular magnifier samples through a small reusable buffer
+    m_sample = QPixmap(m_pixels, m_pixels);
+}
+
+// Copy the neighbourhood of the given point (in logical coordinates) into
+// m_sample. Parts that fall outside of the screenshot are left black.
+void MagnifierWidget::updateSample(const QPoint& center)
+{
+    m_sample.fill(Qt::black);
+
+    const qreal dpr = m_screenshot.devicePixelRatio();
+    QRect source(center.x() - m_magPixels,
+                 center.y() - m_magPixels,
+                 m_pixels,
+                 m_pixels);
+    QRect bounds(QPoint(0, 0), m_screenshot.deviceIndependentSize().toSize());
+    QRect clamped = source.intersected(bounds);
+    if (clamped.isEmpty()) {
+        return;
+    }
+
+    QPainter painter(&m_sample);
+    painter.drawPixmap(QRectF(clamped.translated(-source.topLeft())),
+                       m_screenshot,
+                       QRectF(clamped.x() * dpr,
+                              clamped.y() * dpr,
+                              clamped.width() * dpr,
+                              clamped.height() * dpr));
 }
 void MagnifierWidget::paintEvent(QPaintEvent*)
 {
@@ -49,9 +69,8 @@ void MagnifierWidget::drawMagnifierCircle(QPainter& painter)
     auto x = translated.x() + m_magPixels;
     auto y = translated.y() + m_magPixels;
 
-    int magX = static_cast<int>(x * m_devicePixelRatio - m_magPixels);
-    int magY = static_cast<int>(y * m_devicePixelRatio - m_magPixels);
-    QRectF magniRect(magX, magY, m_pixels, m_pixels);
+    updateSample(translated * m_devicePixelRatio);
+    QRectF magniRect(0, 0, m_pixels, m_pixels);
 
     qreal drawPosX = x + m_magOffset + m_pixels * magZoom / 2;
     if (drawPosX > width() - m_pixels * magZoom / 2) {
@@ -86,8 +105,7 @@ void MagnifierWidget::drawMagnifierCircle(QPainter& painter)
     path.addEllipse(drawPos, m_pixels * magZoom / 2, m_pixels * magZoom / 2);
     painter.setClipPath(path);
 
-    painter.drawPixmapFragments(
-      &frag, 1, m_paddedScreenshot, QPainter::OpaqueHint);
+    painter.drawPixmapFragments(&frag, 1, m_sample, QPainter::OpaqueHint);
     painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
     for (const auto& rect :
          { crossHairTop, crossHairRight, crossHairBottom, crossHairLeft }) {
@@ -26,7 +26,8 @@ private:
     QColor m_color;
     QColor m_borderColor;
     QPixmap m_screenshot;
-    QPixmap m_paddedScreenshot;
+    QPixmap m_sample;
+    void updateSample(const QPoint& center);
     void drawMagnifier(QPainter& painter);
     void drawMagnifierCircle(QPainter& painter);
 };
@@ -23,9 +23,11 @@ CaptureLauncher::CaptureLauncher(QDialog* parent)
     ui->setupUi(this);
     setAttribute(Qt::WA_DeleteOnClose);
     setWindowIcon(QIcon(GlobalValues::iconPath()));
-    bool ok;
 
-    ui->imagePreview->setScreenshot(ScreenGrabber().grabEntireDesktop(ok));
+    ScreenGrabber().grabEntireDesktop().then(
+      this, [this](const QPixmap& screenshot) {
+          ui->imagePreview->setScreenshot(screenshot);
+      });
     ui->imagePreview->setSizePolicy(QSizePolicy::Expanding,
                                     QSizePolicy::Expanding);
 
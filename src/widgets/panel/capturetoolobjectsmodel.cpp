@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "capturetoolobjectsmodel.h"
+#include <QCoreApplication>
+
+// The "<Empty>" entry takes the first row
+#define LAYERS_ROW_OFFSET 1
+
+CaptureToolObjectsModel::CaptureToolObjectsModel(QObject* parent)
+  : QAbstractListModel(parent)
+  , m_iconColor(Qt::white)
+{}
+
+int CaptureToolObjectsModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_layers.size() + LAYERS_ROW_OFFSET;
+}
+
+QVariant CaptureToolObjectsModel::data(const QModelIndex& index,
+                                       int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return {};
+    }
+    if (index.row() < LAYERS_ROW_OFFSET) {
+        if (role == Qt::DisplayRole) {
+            // keep the translation context of the former list widget
+            return QCoreApplication::translate("UtilityPanel", "<Empty>");
+        }
+        return {};
+    }
+
+    const int layer = index.row() - LAYERS_ROW_OFFSET;
+    switch (role) {
+        case Qt::DisplayRole:
+            return m_layers.at(layer).info;
+        case Qt::DecorationRole:
+            return toolIcon(m_tools.at(layer));
+        default:
+            return {};
+    }
+}
+
+void CaptureToolObjectsModel::setCaptureToolObjects(
+  const QList<QPointer<CaptureTool>>& captureToolObjects)
+{
+    QList<Layer> layers;
+    layers.reserve(captureToolObjects.size());
+    for (const auto& tool : captureToolObjects) {
+        layers.append(layerOf(tool));
+    }
+
+    auto sameLayer = [](const Layer& a, const Layer& b) {
+        return a.type == b.type && a.info == b.info;
+    };
+
+    // Rows that are equal at the beginning and at the end are kept as they
+    // are, only the range in between has changed
+    const int oldCount = m_layers.size();
+    const int newCount = layers.size();
+    int prefix = 0;
+    while (prefix < oldCount && prefix < newCount &&
+           sameLayer(m_layers.at(prefix), layers.at(prefix))) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix &&
+           sameLayer(m_layers.at(oldCount - 1 - suffix),
+                     layers.at(newCount - 1 - suffix))) {
+        ++suffix;
+    }
+    const int removed = oldCount - prefix - suffix;
+    const int inserted = newCount - prefix - suffix;
+    const int first = prefix + LAYERS_ROW_OFFSET;
+
+    if (removed == 2 && inserted == 2 &&
+        sameLayer(m_layers.at(prefix), layers.at(prefix + 1)) &&
+        sameLayer(m_layers.at(prefix + 1), layers.at(prefix))) {
+        // Two neighbouring layers have swapped places
+        beginMoveRows(
+          QModelIndex(), first + 1, first + 1, QModelIndex(), first);
+        m_layers = layers;
+        m_tools = captureToolObjects;
+        endMoveRows();
+        return;
+    }
+
+    const int changed = qMin(removed, inserted);
+    if (removed > changed) {
+        beginRemoveRows(QModelIndex(), first + changed, first + removed - 1);
+        m_layers.remove(prefix + changed, removed - changed);
+        m_tools.remove(prefix + changed, removed - changed);
+        endRemoveRows();
+    } else if (inserted > changed) {
+        beginInsertRows(QModelIndex(), first + changed, first + inserted - 1);
+        for (int i = changed; i < inserted; ++i) {
+            m_layers.insert(prefix + i, layers.at(prefix + i));
+            m_tools.insert(prefix + i, captureToolObjects.at(prefix + i));
+        }
+        endInsertRows();
+    }
+
+    // Unchanged rows may still be backed by new copies of the same objects
+    m_layers = layers;
+    m_tools = captureToolObjects;
+    if (changed > 0) {
+        emit dataChanged(index(first), index(first + changed - 1));
+    }
+}
+
+CaptureToolObjectsModel::Layer CaptureToolObjectsModel::layerOf(
+  const QPointer<CaptureTool>& tool) const
+{
+    if (tool.isNull()) {
+        return { CaptureTool::NONE, QString() };
+    }
+    return { tool->type(), tool->info() };
+}
+
+QIcon CaptureToolObjectsModel::toolIcon(
+  const QPointer<CaptureTool>& tool) const
+{
+    if (tool.isNull()) {
+        return {};
+    }
+    auto it = m_icons.constFind(tool->type());
+    if (it == m_icons.constEnd()) {
+        it = m_icons.insert(tool->type(), tool->icon(m_iconColor, false));
+    }
+    return it.value();
+}
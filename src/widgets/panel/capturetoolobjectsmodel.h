@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/capturetool.h"
+#include <QAbstractListModel>
+#include <QIcon>
+#include <QMap>
+#include <QPointer>
+
+/**
+ * @brief List model of the capture tool objects shown in the layers panel.
+ *
+ * The first row is a fixed "<Empty>" entry, the rows after it correspond to
+ * the capture tool objects in stacking order. `setCaptureToolObjects` only
+ * emits the insertions, removals, moves and changes between the previous and
+ * the new list, so views don't rebuild every row after each modification.
+ */
+class CaptureToolObjectsModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit CaptureToolObjectsModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+
+    void setCaptureToolObjects(
+      const QList<QPointer<CaptureTool>>& captureToolObjects);
+
+private:
+    struct Layer
+    {
+        CaptureTool::Type type;
+        QString info;
+    };
+
+    Layer layerOf(const QPointer<CaptureTool>& tool) const;
+    QIcon toolIcon(const QPointer<CaptureTool>& tool) const;
+
+    QList<Layer> m_layers;
+    QList<QPointer<CaptureTool>> m_tools;
+    QColor m_iconColor;
+    // Tool icons are loaded from SVG, keep one per tool type
+    mutable QMap<CaptureTool::Type, QIcon> m_icons;
+};
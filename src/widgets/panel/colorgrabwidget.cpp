@@ -5,6 +5,7 @@
 #include "confighandler.h"
 #include "overlaymessage.h"
 #include "src/core/qguiappcurrentscreen.h"
+#include "src/tools/capturecontext.h"
 #include <QApplication>
 #include <QDebug>
 #include <QKeyEvent>
@@ -24,15 +25,16 @@
 // NOTE: WIDTH1(2) should be divisible by ZOOM1(2) for best precision.
 //       WIDTH1 should be odd so the cursor can be centered on a pixel.
 
-ColorGrabWidget::ColorGrabWidget(QPixmap* p, QWidget* parent)
+ColorGrabWidget::ColorGrabWidget(const CaptureContext* context,
+                                 QWidget* parent)
   : QWidget(parent)
-  , m_pixmap(p)
+  , m_context(context)
   , m_mousePressReceived(false)
   , m_extraZoomActive(false)
   , m_magnifierActive(false)
 {
-    if (p == nullptr) {
-        throw std::logic_error("Pixmap must not be null");
+    if (context == nullptr) {
+        throw std::logic_error("Capture context must not be null");
     }
     setAttribute(Qt::WA_DeleteOnClose);
     // We don't need this widget to receive mouse events because we use
@@ -174,8 +176,11 @@ QColor ColorGrabWidget::getColorAtPoint(const QPoint& p) const
                          currentScreen->devicePixelRatio());
     }
 #endif
-    QPixmap pixel = m_pixmap->copy(QRect(point, point));
-    return pixel.toImage().pixel(0, 0);
+    const QImage& screenshot = m_context->screenshotImage();
+    if (!screenshot.valid(point)) {
+        return Qt::black;
+    }
+    return screenshot.pixel(point);
 }
 
 void ColorGrabWidget::setExtraZoomActive(bool active)
@@ -224,7 +229,7 @@ void ColorGrabWidget::updateWidget()
     // Store a pixmap containing the zoomed-in section around the cursor
     QRect sourceRect(0, 0, width / zoom, width / zoom);
     sourceRect.moveCenter(adjustedCursorPos);
-    m_previewImage = m_pixmap->copy(sourceRect).toImage();
+    m_previewImage = m_context->screenshotImage().copy(sourceRect);
     // Repaint
     update();
 }
@@ -234,5 +239,6 @@ void ColorGrabWidget::finalize()
     qApp->removeEventFilter(this);
     qApp->restoreOverrideCursor();
     OverlayMessage::pop();
+    m_context->releaseScreenshotImage();
     close();
 }
@@ -5,12 +5,13 @@
 
 class SidePanelWidget;
 class OverlayMessage;
+struct CaptureContext;
 
 class ColorGrabWidget : public QWidget
 {
     Q_OBJECT
 public:
-    ColorGrabWidget(QPixmap* p, QWidget* parent = nullptr);
+    ColorGrabWidget(const CaptureContext* context, QWidget* parent = nullptr);
 
     void startGrabbing();
 
@@ -33,7 +34,7 @@ private:
     void updateWidget();
     void finalize();
 
-    QPixmap* m_pixmap;
+    const CaptureContext* m_context;
     QImage m_previewImage;
     QColor m_color;
 
@@ -20,10 +20,11 @@
 #include <QScreen>
 #endif
 
-SidePanelWidget::SidePanelWidget(QPixmap* p, QWidget* parent)
+SidePanelWidget::SidePanelWidget(const CaptureContext* context,
+                                 QWidget* parent)
   : QWidget(parent)
   , m_layout(new QVBoxLayout(this))
-  , m_pixmap(p)
+  , m_context(context)
 {
 
     if (parent != nullptr) {
@@ -157,7 +158,7 @@ void SidePanelWidget::onToolSizeChanged(int t)
 void SidePanelWidget::startColorGrab()
 {
     m_revertColor = m_color;
-    m_colorGrabber = new ColorGrabWidget(m_pixmap);
+    m_colorGrabber = new ColorGrabWidget(m_context);
     connect(m_colorGrabber,
             &ColorGrabWidget::colorUpdated,
             this,
@@ -15,6 +15,7 @@ class ColorGrabWidget;
 class QColorPickingEventFilter;
 class QSlider;
 class QCheckBox;
+struct CaptureContext;
 
 constexpr int maxToolSize = 50;
 constexpr int minSliderWidth = 100;
@@ -26,7 +27,8 @@ class SidePanelWidget : public QWidget
     friend class QColorPickingEventFilter;
 
 public:
-    explicit SidePanelWidget(QPixmap* p, QWidget* parent = nullptr);
+    explicit SidePanelWidget(const CaptureContext* context,
+                             QWidget* parent = nullptr);
 
 signals:
     void colorChanged(const QColor& color);
@@ -58,7 +60,7 @@ private:
     color_widgets::ColorWheel* m_colorWheel;
     QLabel* m_colorLabel;
     QLineEdit* m_colorHex;
-    QPixmap* m_pixmap;
+    const CaptureContext* m_context;
     QColor m_color;
     QColor m_revertColor;
     QSpinBox* m_toolSizeSpin;
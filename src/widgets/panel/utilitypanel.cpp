@@ -2,9 +2,10 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "utilitypanel.h"
+#include "capturetoolobjectsmodel.h"
 #include "capturewidget.h"
 #include <QHBoxLayout>
-#include <QListWidget>
+#include <QListView>
 #include <QPropertyAnimation>
 #include <QPushButton>
 #include <QScrollArea>
@@ -21,6 +22,7 @@ UtilityPanel::UtilityPanel(CaptureWidget* captureWidget)
   , m_hideAnimation(nullptr)
   , m_layersLayout(nullptr)
   , m_captureTools(nullptr)
+  , m_captureToolsModel(nullptr)
   , m_buttonDelete(nullptr)
   , m_buttonMoveUp(nullptr)
   , m_buttonMoveDown(nullptr)
@@ -135,11 +137,15 @@ void UtilityPanel::initInternalPanel()
       QStringLiteral("QScrollArea {background-color: %1}").arg(bgColor.name()));
     m_internalPanel->hide();
 
-    m_captureTools = new QListWidget(this);
-    connect(m_captureTools,
-            &QListWidget::currentRowChanged,
+    m_captureToolsModel = new CaptureToolObjectsModel(this);
+    m_captureTools = new QListView(this);
+    m_captureTools->setModel(m_captureToolsModel);
+    connect(m_captureTools->selectionModel(),
+            &QItemSelectionModel::currentRowChanged,
             this,
-            &UtilityPanel::onCurrentRowChanged);
+            [this](const QModelIndex& current) {
+                onCurrentRowChanged(current.row());
+            });
 
     auto* layersButtons = new QHBoxLayout();
     m_layersLayout->addLayout(layersButtons);
@@ -192,42 +198,49 @@ void UtilityPanel::initInternalPanel()
     m_bottomLayout->addWidget(closeButton);
 }
 
-void UtilityPanel::fillCaptureTools(
+void UtilityPanel::updateCaptureTools(
   const QList<QPointer<CaptureTool>>& captureToolObjects)
 {
-    int currentSelection = m_captureTools->currentRow();
-    m_captureTools->clear();
-    m_captureTools->addItem(tr("<Empty>"));
-
-    for (auto toolItem : captureToolObjects) {
-        auto* item = new QListWidgetItem(
-          toolItem->icon(QColor(Qt::white), false), toolItem->info());
-        m_captureTools->addItem(item);
-    }
-    if (currentSelection >= 0 && currentSelection < m_captureTools->count()) {
-        m_captureTools->setCurrentRow(currentSelection);
-    }
+    // The model only reports the rows that differ, the current row follows
+    // the layer it belongs to
+    m_captureToolsModel->setCaptureToolObjects(captureToolObjects);
+    updateLayerButtons();
 }
 
 void UtilityPanel::setActiveLayer(int index)
 {
     Q_ASSERT(index >= -1);
-    m_captureTools->setCurrentRow(index + 1);
+    setCurrentRow(index + 1);
 }
 
 int UtilityPanel::activeLayerIndex()
 {
-    return m_captureTools->currentRow() >= 0 ? m_captureTools->currentRow() - 1
-                                             : -1;
+    return currentRow() >= 0 ? currentRow() - 1 : -1;
 }
 
-void UtilityPanel::onCurrentRowChanged(int currentRow)
+int UtilityPanel::currentRow() const
+{
+    return m_captureTools->currentIndex().row();
+}
+
+void UtilityPanel::setCurrentRow(int row)
 {
-    m_buttonDelete->setDisabled(currentRow <= 0);
-    m_buttonMoveDown->setDisabled(currentRow == 0 ||
-                                  currentRow + 1 == m_captureTools->count());
-    m_buttonMoveUp->setDisabled(currentRow <= 1);
+    m_captureTools->setCurrentIndex(m_captureToolsModel->index(row));
+}
+
+void UtilityPanel::updateLayerButtons()
+{
+    const int row = currentRow();
+    m_buttonDelete->setDisabled(row <= 0);
+    m_buttonMoveDown->setDisabled(
+      row <= 0 || row + 1 == m_captureToolsModel->rowCount());
+    m_buttonMoveUp->setDisabled(row <= 1);
+}
 
+void UtilityPanel::onCurrentRowChanged(int currentRow)
+{
+    Q_UNUSED(currentRow)
+    updateLayerButtons();
     emit layerChanged(activeLayerIndex());
 }
 
@@ -235,33 +248,35 @@ void UtilityPanel::slotUpClicked(bool clicked)
 {
     Q_UNUSED(clicked);
     // subtract 1 because there's <empty> in m_captureTools as [0] element
-    int toolRow = m_captureTools->currentRow() - 1;
-    m_captureTools->setCurrentRow(toolRow);
-    emit moveUpClicked(toolRow);
+    int row = currentRow();
+    emit moveUpClicked(row - 1);
+    // the model usually moves the current row along with the layer already
+    setCurrentRow(row - 1);
 }
 
 void UtilityPanel::slotDownClicked(bool clicked)
 {
     Q_UNUSED(clicked);
     // subtract 1 because there's <empty> in m_captureTools as [0] element
-    int toolRow = m_captureTools->currentRow() - 1;
-    m_captureTools->setCurrentRow(toolRow + 2);
-    emit moveDownClicked(toolRow);
+    int row = currentRow();
+    emit moveDownClicked(row - 1);
+    // the model usually moves the current row along with the layer already
+    setCurrentRow(row + 1);
 }
 
 void UtilityPanel::slotButtonDelete(bool clicked)
 {
     Q_UNUSED(clicked)
-    int currentRow = m_captureTools->currentRow();
-    if (currentRow > 0) {
-        m_captureWidget->removeToolObject(currentRow);
-        if (currentRow >= m_captureTools->count()) {
-            currentRow = m_captureTools->count() - 1;
+    int row = currentRow();
+    if (row > 0) {
+        m_captureWidget->removeToolObject(row);
+        if (row >= m_captureToolsModel->rowCount()) {
+            row = m_captureToolsModel->rowCount() - 1;
         }
     } else {
-        currentRow = 0;
+        row = 0;
     }
-    m_captureTools->setCurrentRow(currentRow);
+    setCurrentRow(row);
 }
 
 bool UtilityPanel::isVisible() const
@@ -11,9 +11,10 @@ class QVBoxLayout;
 class QPropertyAnimation;
 class QScrollArea;
 class QPushButton;
-class QListWidget;
+class QListView;
 class QPushButton;
 class CaptureWidget;
+class CaptureToolObjectsModel;
 
 class UtilityPanel : public QWidget
 {
@@ -27,8 +28,8 @@ public:
     void pushWidget(QWidget* widget);
     void hide();
     void show();
-    void fillCaptureTools(
-      const QList<QPointer<CaptureTool>>& captureToolObjectsHistory);
+    void updateCaptureTools(
+      const QList<QPointer<CaptureTool>>& captureToolObjects);
     void setActiveLayer(int index);
     int activeLayerIndex();
     bool isVisible() const;
@@ -49,6 +50,9 @@ private slots:
 
 private:
     void initInternalPanel();
+    int currentRow() const;
+    void setCurrentRow(int row);
+    void updateLayerButtons();
 
     QPointer<QWidget> m_toolWidget;
     QScrollArea* m_internalPanel;
@@ -58,7 +62,8 @@ private:
     QPropertyAnimation* m_showAnimation;
     QPropertyAnimation* m_hideAnimation;
     QVBoxLayout* m_layersLayout;
-    QListWidget* m_captureTools;
+    QListView* m_captureTools;
+    CaptureToolObjectsModel* m_captureToolsModel;
     QPushButton* m_buttonDelete;
     QPushButton* m_buttonMoveUp;
     QPushButton* m_buttonMoveDown;
@@ -196,8 +196,14 @@ void TrayIcon::enableCheckUpdatesAction(bool enable)
 
 void TrayIcon::startGuiCapture()
 {
-    auto* widget = Flameshot::instance()->gui();
 #if !defined(DISABLE_UPDATE_CHECKER)
-    FlameshotDaemon::instance()->showUpdateNotificationIfAvailable(widget);
+    Flameshot::instance()->gui().then(this, [](CaptureWidget* widget) {
+        if (widget != nullptr) {
+            FlameshotDaemon::instance()->showUpdateNotificationIfAvailable(
+              widget);
+        }
+    });
+#else
+    Flameshot::instance()->gui();
 #endif
 }
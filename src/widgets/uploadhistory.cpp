@@ -1,99 +1,119 @@
 #include "uploadhistory.h"
 #include "./ui_uploadhistory.h"
+#include "src/core/flameshotdaemon.h"
 #include "src/tools/imgupload/imguploadermanager.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/history.h"
-#include "uploadlineitem.h"
+#include "uploadhistorydelegate.h"
+#include "uploadhistorymodel.h"
 
-#include <QDateTime>
-#include <QFileInfo>
-#include <QPixmap>
-
-void scaleThumbnail(QPixmap& pixmap)
-{
-    if (pixmap.height() / HISTORYPIXMAP_MAX_PREVIEW_HEIGHT >=
-        pixmap.width() / HISTORYPIXMAP_MAX_PREVIEW_WIDTH) {
-        pixmap = pixmap.scaledToHeight(HISTORYPIXMAP_MAX_PREVIEW_HEIGHT,
-                                       Qt::SmoothTransformation);
-    } else {
-        pixmap = pixmap.scaledToWidth(HISTORYPIXMAP_MAX_PREVIEW_WIDTH,
-                                      Qt::SmoothTransformation);
-    }
-}
-
-void clearHistoryLayout(QLayout* layout)
-{
-    while (layout->count() != 0) {
-        delete layout->takeAt(0);
-    }
-}
+#include <QDesktopServices>
+#include <QMessageBox>
+#include <QPersistentModelIndex>
+#include <QPushButton>
+#include <QUrl>
 
 UploadHistory::UploadHistory(QWidget* parent)
   : QWidget(parent)
   , ui(new Ui::UploadHistory)
+  , m_model(new UploadHistoryModel(this))
+  , m_emptyMessage(nullptr)
 {
     ui->setupUi(this);
     setAttribute(Qt::WA_DeleteOnClose);
 
     setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    auto* delegate = new UploadHistoryDelegate(this);
+    ui->historyList->setModel(m_model);
+    ui->historyList->setItemDelegate(delegate);
+    // Lets the delegate draw the hovered button
+    ui->historyList->setMouseTracking(true);
+
+    connect(delegate,
+            &UploadHistoryDelegate::copyUrlClicked,
+            this,
+            [](const QModelIndex& index) {
+                FlameshotDaemon::copyToClipboard(
+                  index.data(UploadHistoryModel::UrlRole).toString());
+            });
+    connect(delegate,
+            &UploadHistoryDelegate::openUrlClicked,
+            this,
+            [](const QModelIndex& index) {
+                QDesktopServices::openUrl(
+                  QUrl(index.data(UploadHistoryModel::UrlRole).toString()));
+            });
+    connect(delegate,
+            &UploadHistoryDelegate::deleteClicked,
+            this,
+            [this](const QModelIndex& index) { deleteEntry(index); });
+
+    // Uploads that complete while the history is open
+    connect(m_model, &UploadHistoryModel::rowsInserted, this, [this]() {
+        if (m_emptyMessage != nullptr) {
+            delete m_emptyMessage;
+            m_emptyMessage = nullptr;
+            ui->historyList->show();
+        }
+    });
+    connect(m_model, &UploadHistoryModel::rowsRemoved, this, [this]() {
+        if (m_model->rowCount() == 0) {
+            setEmptyMessage();
+        }
+    });
 }
 
 void UploadHistory::loadHistory()
 {
-    clearHistoryLayout(ui->historyContainer);
-
     History history = History();
-    QList<QString> historyFiles = history.history();
+    m_model->setEntries(history.path(), history.entries());
 
-    if (historyFiles.isEmpty()) {
+    if (m_model->rowCount() == 0) {
         setEmptyMessage();
-    } else {
-        for (const auto& fileName : historyFiles) {
-            addLine(history.path(), fileName);
-        }
     }
 }
 
 void UploadHistory::setEmptyMessage()
 {
-    auto* buttonEmpty = new QPushButton;
-    buttonEmpty->setText(tr("Screenshots history is empty"));
-    buttonEmpty->setMinimumSize(1, HISTORYPIXMAP_MAX_PREVIEW_HEIGHT);
-    connect(
-      buttonEmpty, &QPushButton::clicked, this, [=, this]() { this->close(); });
-    ui->historyContainer->addWidget(buttonEmpty);
+    if (m_emptyMessage != nullptr) {
+        return;
+    }
+    ui->historyList->hide();
+    m_emptyMessage = new QPushButton;
+    m_emptyMessage->setText(tr("Screenshots history is empty"));
+    m_emptyMessage->setMinimumSize(1, HISTORYPIXMAP_MAX_PREVIEW_HEIGHT);
+    connect(m_emptyMessage, &QPushButton::clicked, this, [=, this]() {
+        this->close();
+    });
+    ui->verticalLayout->addWidget(m_emptyMessage);
 }
 
-void UploadHistory::addLine(const QString& path, const QString& fileName)
+void UploadHistory::deleteEntry(const QModelIndex& index)
 {
-    QString fullFileName = path + fileName;
-
-    History history;
-    HistoryFileName unpackFileName = history.unpackFileName(fileName);
-
-    QString url = ImgUploaderManager(this).url() + unpackFileName.file;
-
-    // load pixmap
-    QPixmap pixmap;
-    pixmap.load(fullFileName, "png");
-    scaleThumbnail(pixmap);
-
-    // get file info
-    auto fileInfo = QFileInfo(fullFileName);
-    QString lastModified =
-      fileInfo.lastModified().toString("yyyy-MM-dd\nhh:mm:ss");
-
-    auto* line = new UploadLineItem(
-      this, pixmap, lastModified, url, fullFileName, unpackFileName);
+    // Uploads may be added or removed while the confirmation is shown
+    QPersistentModelIndex entryIndex(index);
+    if (ConfigHandler().historyConfirmationToDelete() &&
+        QMessageBox::No ==
+          QMessageBox::question(
+            this,
+            tr("Confirm to delete"),
+            tr("Are you sure you want to delete a screenshot from the "
+               "latest uploads and server?"),
+            QMessageBox::Yes | QMessageBox::No)) {
+        return;
+    }
+    if (!entryIndex.isValid()) {
+        return;
+    }
 
-    connect(line, &UploadLineItem::requestedDeletion, this, [=, this]() {
-        if (ui->historyContainer->count() <= 1) {
-            setEmptyMessage();
-        }
-        delete line;
-    });
+    const HistoryEntry entry = m_model->entry(entryIndex.row());
+    ImgUploaderBase* imgUploaderBase =
+      ImgUploaderManager(this).uploader(entry.storage);
+    imgUploaderBase->deleteImage(entry.remoteName, entry.token);
 
-    ui->historyContainer->addWidget(line);
+    History().remove(entry.file);
+    m_model->removeEntry(entryIndex.row());
 }
 
 UploadHistory::~UploadHistory()
@@ -3,15 +3,16 @@
 
 #include <QWidget>
 
+class QModelIndex;
+class QPushButton;
+class UploadHistoryModel;
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class UploadHistory;
 }
 QT_END_NAMESPACE
 
-void clearHistoryLayout(QLayout* layout);
-void scaleThumbnail(QPixmap& input);
-
 class UploadHistory : public QWidget
 {
     Q_OBJECT
@@ -25,8 +26,10 @@ public slots:
 
 private:
     void setEmptyMessage();
-    void addLine(QString const&, QString const&);
+    void deleteEntry(const QModelIndex& index);
 
     Ui::UploadHistory* ui;
+    UploadHistoryModel* m_model;
+    QPushButton* m_emptyMessage;
 };
-#endif // UPLOADHISTORY_H
\ No newline at end of file
+#endif // UPLOADHISTORY_H
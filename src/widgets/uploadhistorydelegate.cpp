@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "uploadhistorydelegate.h"
+#include "src/utils/history.h"
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QCursor>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyleOptionButton>
+
+// Around the row and between its parts
+#define ROW_MARGIN 6
+#define DELETE_ICON_SIZE 16
+
+UploadHistoryDelegate::UploadHistoryDelegate(QObject* parent)
+  : QStyledItemDelegate(parent)
+  , m_deleteIcon(QStringLiteral(":/img/material/black/delete.svg"))
+{}
+
+void UploadHistoryDelegate::paint(QPainter* painter,
+                                  const QStyleOptionViewItem& option,
+                                  const QModelIndex& index) const
+{
+    const QWidget* widget = option.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+
+    QStyleOptionViewItem background = option;
+    initStyleOption(&background, index);
+    background.text.clear();
+    background.icon = QIcon();
+    style->drawControl(QStyle::CE_ItemViewItem, &background, painter, widget);
+
+    const QRect row = option.rect.adjusted(
+      ROW_MARGIN, ROW_MARGIN, -ROW_MARGIN, -ROW_MARGIN);
+    const QRect thumbnailArea(row.topLeft(),
+                              QSize(HISTORYPIXMAP_MAX_PREVIEW_WIDTH,
+                                    HISTORYPIXMAP_MAX_PREVIEW_HEIGHT));
+    QPixmap thumbnail = index.data(Qt::DecorationRole).value<QPixmap>();
+    if (!thumbnail.isNull()) {
+        QRect target(QPoint(),
+                     thumbnail.size() / thumbnail.devicePixelRatio());
+        target.moveCenter(thumbnailArea.center());
+        painter->drawPixmap(target, thumbnail);
+    }
+
+    QRect firstButton = buttonRect(option, COPY_URL_BUTTON);
+    QRect textArea(thumbnailArea.right() + ROW_MARGIN,
+                   row.top(),
+                   firstButton.left() - ROW_MARGIN - thumbnailArea.right() -
+                     ROW_MARGIN,
+                   row.height());
+    painter->save();
+    painter->setPen(option.palette.color(option.state & QStyle::State_Selected
+                                           ? QPalette::HighlightedText
+                                           : QPalette::Text));
+    painter->drawText(textArea,
+                      Qt::AlignRight | Qt::AlignVCenter,
+                      index.data(Qt::DisplayRole).toString());
+    painter->restore();
+
+    for (int button = 0; button < BUTTON_COUNT; ++button) {
+        QStyleOptionButton buttonOpt = buttonOption(option, button);
+        style->drawControl(QStyle::CE_PushButton, &buttonOpt, painter, widget);
+    }
+}
+
+QSize UploadHistoryDelegate::sizeHint(const QStyleOptionViewItem& option,
+                                      const QModelIndex& index) const
+{
+    Q_UNUSED(index)
+    int width = HISTORYPIXMAP_MAX_PREVIEW_WIDTH + 3 * ROW_MARGIN +
+                option.fontMetrics.horizontalAdvance("0000-00-00");
+    for (int button = 0; button < BUTTON_COUNT; ++button) {
+        width += buttonRect(option, button).width() + ROW_MARGIN;
+    }
+    return { width, HISTORYPIXMAP_MAX_PREVIEW_HEIGHT + 2 * ROW_MARGIN };
+}
+
+bool UploadHistoryDelegate::editorEvent(QEvent* event,
+                                        QAbstractItemModel* model,
+                                        const QStyleOptionViewItem& option,
+                                        const QModelIndex& index)
+{
+    if (event->type() != QEvent::MouseButtonPress &&
+        event->type() != QEvent::MouseButtonRelease) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+    auto* mouseEvent = static_cast<QMouseEvent*>(event);
+    const QPoint pos = mouseEvent->position().toPoint();
+    for (int button = 0; button < BUTTON_COUNT; ++button) {
+        if (!buttonRect(option, button).contains(pos)) {
+            continue;
+        }
+        if (event->type() == QEvent::MouseButtonRelease &&
+            mouseEvent->button() == Qt::LeftButton) {
+            switch (button) {
+                case COPY_URL_BUTTON:
+                    emit copyUrlClicked(index);
+                    break;
+                case OPEN_URL_BUTTON:
+                    emit openUrlClicked(index);
+                    break;
+                default:
+                    emit deleteClicked(index);
+                    break;
+            }
+        }
+        return true;
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+QStyleOptionButton UploadHistoryDelegate::buttonOption(
+  const QStyleOptionViewItem& option,
+  int button) const
+{
+    QStyleOptionButton buttonOpt;
+    if (option.widget != nullptr) {
+        buttonOpt.initFrom(option.widget);
+    }
+    buttonOpt.state = QStyle::State_Enabled | QStyle::State_Raised;
+    buttonOpt.rect = buttonRect(option, button);
+    buttonOpt.text = buttonText(button);
+    if (button == DELETE_BUTTON) {
+        buttonOpt.icon = m_deleteIcon;
+        buttonOpt.iconSize = QSize(DELETE_ICON_SIZE, DELETE_ICON_SIZE);
+    }
+
+    // Buttons are painted, so their hover state comes from the cursor
+    auto* view = qobject_cast<const QAbstractItemView*>(option.widget);
+    if (view != nullptr) {
+        QPoint cursor = view->viewport()->mapFromGlobal(QCursor::pos());
+        if (buttonOpt.rect.contains(cursor)) {
+            buttonOpt.state |= QStyle::State_MouseOver;
+        }
+    }
+    return buttonOpt;
+}
+
+// Buttons are right aligned, in the order of `Button`
+QRect UploadHistoryDelegate::buttonRect(const QStyleOptionViewItem& option,
+                                        int button) const
+{
+    const QWidget* widget = option.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+    auto buttonSize = [&](int index) {
+        QStyleOptionButton sizeOpt;
+        sizeOpt.text = buttonText(index);
+        QSize content =
+          index == DELETE_BUTTON
+            ? QSize(DELETE_ICON_SIZE, DELETE_ICON_SIZE)
+            : option.fontMetrics.size(Qt::TextShowMnemonic, sizeOpt.text);
+        return style->sizeFromContents(
+          QStyle::CT_PushButton, &sizeOpt, content, widget);
+    };
+
+    int right = option.rect.right() - ROW_MARGIN;
+    for (int i = BUTTON_COUNT - 1; i >= 0; --i) {
+        QSize size = buttonSize(i);
+        QRect rect(right - size.width() + 1,
+                   option.rect.center().y() - size.height() / 2,
+                   size.width(),
+                   size.height());
+        if (i == button) {
+            return rect;
+        }
+        right = rect.left() - ROW_MARGIN;
+    }
+    return {};
+}
+
+QString UploadHistoryDelegate::buttonText(int button)
+{
+    switch (button) {
+        case COPY_URL_BUTTON:
+            return tr("Copy URL");
+        case OPEN_URL_BUTTON:
+            return tr("Open In Browser");
+        default:
+            return {};
+    }
+}
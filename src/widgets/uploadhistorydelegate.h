@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QIcon>
+#include <QStyledItemDelegate>
+
+class QStyleOptionButton;
+
+/**
+ * @brief Draws a row of the upload history: the thumbnail, the upload time
+ * and the buttons to copy the URL, open it and delete the upload.
+ *
+ * The buttons are painted rather than being widgets, so a row costs nothing
+ * until it is on screen. Clicks on them are reported through the signals.
+ */
+class UploadHistoryDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit UploadHistoryDelegate(QObject* parent = nullptr);
+
+    void paint(QPainter* painter,
+               const QStyleOptionViewItem& option,
+               const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option,
+                   const QModelIndex& index) const override;
+    bool editorEvent(QEvent* event,
+                     QAbstractItemModel* model,
+                     const QStyleOptionViewItem& option,
+                     const QModelIndex& index) override;
+
+signals:
+    void copyUrlClicked(const QModelIndex& index);
+    void openUrlClicked(const QModelIndex& index);
+    void deleteClicked(const QModelIndex& index);
+
+private:
+    enum Button
+    {
+        COPY_URL_BUTTON,
+        OPEN_URL_BUTTON,
+        DELETE_BUTTON,
+        BUTTON_COUNT,
+    };
+
+    QStyleOptionButton buttonOption(const QStyleOptionViewItem& option,
+                                    int button) const;
+    QRect buttonRect(const QStyleOptionViewItem& option, int button) const;
+    static QString buttonText(int button);
+
+    QIcon m_deleteIcon;
+};
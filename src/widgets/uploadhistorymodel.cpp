@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "uploadhistorymodel.h"
+#include "src/tools/imgupload/imguploadermanager.h"
+#include "src/utils/history.h"
+#include "src/utils/historythumbnailcache.h"
+
+UploadHistoryModel::UploadHistoryModel(QObject* parent)
+  : QAbstractListModel(parent)
+{
+    connect(HistoryThumbnailCache::instance(),
+            &HistoryThumbnailCache::thumbnailReady,
+            this,
+            &UploadHistoryModel::onThumbnailReady);
+    connect(History::notifier(),
+            &HistoryNotifier::entryAdded,
+            this,
+            &UploadHistoryModel::onEntryAdded);
+    connect(History::notifier(),
+            &HistoryNotifier::entryRemoved,
+            this,
+            &UploadHistoryModel::onEntryRemoved);
+}
+
+int UploadHistoryModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_entries.size();
+}
+
+QVariant UploadHistoryModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_entries.size()) {
+        return {};
+    }
+    const HistoryEntry& entry = m_entries.at(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            return entry.timestamp.toString("yyyy-MM-dd\nhh:mm:ss");
+        case Qt::DecorationRole:
+            return HistoryThumbnailCache::instance()->thumbnail(
+              thumbnailKey(entry), m_directory + entry.file);
+        case UrlRole:
+            return ImgUploaderManager::link(entry.storage, entry.remoteName);
+        default:
+            return {};
+    }
+}
+
+void UploadHistoryModel::setEntries(const QString& directory,
+                                    const QList<HistoryEntry>& entries)
+{
+    beginResetModel();
+    m_directory = directory;
+    m_entries = entries;
+    indexRows();
+    endResetModel();
+}
+
+const HistoryEntry& UploadHistoryModel::entry(int row) const
+{
+    return m_entries.at(row);
+}
+
+void UploadHistoryModel::removeEntry(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+    HistoryThumbnailCache::instance()->remove(
+      thumbnailKey(m_entries.at(row)));
+    m_entries.removeAt(row);
+    indexRows();
+    endRemoveRows();
+}
+
+// A file saved again under the same name gets a new key
+QString UploadHistoryModel::thumbnailKey(const HistoryEntry& entry)
+{
+    return entry.file + QLatin1Char('@') +
+           QString::number(entry.timestamp.toMSecsSinceEpoch());
+}
+
+void UploadHistoryModel::indexRows()
+{
+    m_rows.clear();
+    for (int i = 0; i < m_entries.size(); ++i) {
+        m_rows.insert(thumbnailKey(m_entries.at(i)), i);
+    }
+}
+
+void UploadHistoryModel::onEntryAdded(const HistoryEntry& entry,
+                                      const QImage& thumbnail)
+{
+    // Saved again under the same name
+    onEntryRemoved(entry.file);
+
+    HistoryThumbnailCache::instance()->insert(thumbnailKey(entry), thumbnail);
+    beginInsertRows(QModelIndex(), 0, 0);
+    m_entries.prepend(entry);
+    indexRows();
+    endInsertRows();
+}
+
+void UploadHistoryModel::onEntryRemoved(const QString& file)
+{
+    for (int row = 0; row < m_entries.size(); ++row) {
+        if (m_entries.at(row).file == file) {
+            removeEntry(row);
+            return;
+        }
+    }
+}
+
+void UploadHistoryModel::onThumbnailReady(const QString& key)
+{
+    auto it = m_rows.constFind(key);
+    if (it != m_rows.constEnd()) {
+        QModelIndex changed = index(it.value());
+        emit dataChanged(changed, changed, { Qt::DecorationRole });
+    }
+}
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/historyindex.h"
+#include <QAbstractListModel>
+#include <QHash>
+#include <QImage>
+
+/**
+ * @brief List model of the upload history entries, newest first.
+ *
+ * Thumbnails are only requested from HistoryThumbnailCache when a view asks
+ * for the decoration of a row, that is for the rows on screen, and the row is
+ * updated once its thumbnail has been decoded. Entries saved or removed while
+ * the model is shown are added or removed as single rows.
+ */
+class UploadHistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Roles
+    {
+        UrlRole = Qt::UserRole + 1,
+    };
+
+    explicit UploadHistoryModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+
+    void setEntries(const QString& directory,
+                    const QList<HistoryEntry>& entries);
+    const HistoryEntry& entry(int row) const;
+    void removeEntry(int row);
+
+private:
+    static QString thumbnailKey(const HistoryEntry& entry);
+    void indexRows();
+    void onThumbnailReady(const QString& key);
+    void onEntryAdded(const HistoryEntry& entry, const QImage& thumbnail);
+    void onEntryRemoved(const QString& file);
+
+    QString m_directory;
+    QList<HistoryEntry> m_entries;
+    QHash<QString, int> m_rows;
+};
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+/**
+ * @brief Time `step` over a number of iterations and summarize it as JSON.
+ *
+ * One untimed round is run first to warm up caches. `reset`, when given, runs
+ * untimed after every step to bring the state back.
+ */
+inline QJsonObject measure(const QString& name,
+                           int iterations,
+                           const std::function<void()>& step,
+                           const std::function<void()>& reset = {})
+{
+    step();
+    if (reset) {
+        reset();
+    }
+
+    QList<double> samples;
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        step();
+        samples << timer.nsecsElapsed() / 1e6;
+        if (reset) {
+            reset();
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double total = std::accumulate(samples.begin(), samples.end(), 0.0);
+    return { { "name", name },
+             { "iterations", iterations },
+             { "min_ms", samples.first() },
+             { "median_ms", samples.at(samples.size() / 2) },
+             { "mean_ms", total / samples.size() },
+             { "max_ms", samples.last() } };
+}
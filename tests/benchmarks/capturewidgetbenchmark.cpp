@@ -0,0 +1,299 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+// Headless timings of the capture editor: tool compositing, painting, object
+// picking, undo/redo, layer reordering and the invert tool at several region
+// sizes. The widget is rendered with the offscreen platform plugin on a
+// synthetic screenshot and the results are written to stdout as JSON.
+
+#include "benchmarkstats.h"
+#include "src/core/capturerequest.h"
+#include "src/tools/capturetool.h"
+#include "src/tools/toolfactory.h"
+#include "src/widgets/capture/capturewidget.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QtMath>
+#include <functional>
+
+#define TILE_SIZE 64
+#define PENCIL_POINTS 32
+
+class CaptureWidgetBenchmark
+{
+public:
+    CaptureWidgetBenchmark(const QSize& size, int objects, int iterations);
+    ~CaptureWidgetBenchmark();
+
+    QJsonObject run();
+
+private:
+    QPixmap syntheticScreenshot();
+    QPoint randomPoint();
+    CaptureTool* createTool(CaptureTool::Type type, int index);
+    void populate();
+    QJsonObject measure(const QString& name,
+                        const std::function<void()>& step,
+                        const std::function<void()>& reset = {});
+    QJsonArray measureInvert();
+
+    QSize m_size;
+    int m_objects;
+    int m_iterations;
+    // Fixed seed so that every run draws the same scene
+    QRandomGenerator m_random{ 2017 };
+    CaptureWidget* m_widget;
+    QList<QPoint> m_probes;
+};
+
+CaptureWidgetBenchmark::CaptureWidgetBenchmark(const QSize& size,
+                                               int objects,
+                                               int iterations)
+  : m_size(size)
+  , m_objects(objects)
+  , m_iterations(iterations)
+{
+    m_widget = new CaptureWidget(CaptureRequest(CaptureRequest::GRAPHICAL_MODE),
+                                 syntheticScreenshot(),
+                                 false);
+    m_widget->resize(m_size);
+    m_widget->show();
+    m_widget->selectAll();
+    populate();
+    qApp->processEvents();
+}
+
+CaptureWidgetBenchmark::~CaptureWidgetBenchmark()
+{
+    delete m_widget;
+}
+
+QPixmap CaptureWidgetBenchmark::syntheticScreenshot()
+{
+    // Flat tiles with some noise on top look closer to a desktop than a plain
+    // gradient and give pixelate and invert real work to do
+    QImage image(m_size, QImage::Format_RGB32);
+    QPainter painter(&image);
+    for (int y = 0; y < m_size.height(); y += TILE_SIZE) {
+        for (int x = 0; x < m_size.width(); x += TILE_SIZE) {
+            painter.fillRect(
+              x, y, TILE_SIZE, TILE_SIZE, QColor::fromRgb(m_random.generate()));
+        }
+    }
+    painter.end();
+    for (int i = 0; i < m_size.width() * m_size.height() / 64; ++i) {
+        image.setPixel(randomPoint(), m_random.generate());
+    }
+    return QPixmap::fromImage(image);
+}
+
+QPoint CaptureWidgetBenchmark::randomPoint()
+{
+    return { m_random.bounded(m_size.width()),
+             m_random.bounded(m_size.height()) };
+}
+
+CaptureTool* CaptureWidgetBenchmark::createTool(CaptureTool::Type type,
+                                                int index)
+{
+    CaptureContext& context = m_widget->m_context;
+    CaptureTool* tool = ToolFactory().CreateTool(type, m_widget);
+    // Keep every object inside the screenshot
+    QPoint start = randomPoint();
+    start.setX(qMin(start.x(), m_size.width() - 400));
+    start.setY(qMin(start.y(), m_size.height() - 200));
+    context.mousePos = start;
+    tool->drawStart(context);
+
+    switch (type) {
+        case CaptureTool::TYPE_PENCIL:
+            for (int i = 1; i <= PENCIL_POINTS; ++i) {
+                tool->drawMove(start +
+                               QPoint(i * 8, qRound(40 * qSin(i / 3.0))));
+            }
+            break;
+        case CaptureTool::TYPE_TEXT:
+            tool->onSizeChanged(context.toolSize);
+            QMetaObject::invokeMethod(
+              tool,
+              "updateText",
+              Q_ARG(QString,
+                    QStringLiteral("Benchmark %1\nsecond line").arg(index)));
+            break;
+        case CaptureTool::TYPE_CIRCLECOUNT:
+            tool->setCount(context.circleCount++);
+            tool->drawMove(start + QPoint(60, 60));
+            break;
+        default:
+            tool->drawMove(start + QPoint(320, 180));
+            break;
+    }
+    tool->drawEnd(start);
+    return tool;
+}
+
+void CaptureWidgetBenchmark::populate()
+{
+    const QList<CaptureTool::Type> types = { CaptureTool::TYPE_PENCIL,
+                                             CaptureTool::TYPE_ARROW,
+                                             CaptureTool::TYPE_TEXT,
+                                             CaptureTool::TYPE_PIXELATE,
+                                             CaptureTool::TYPE_CIRCLECOUNT };
+    QList<CaptureTool*> tools;
+    for (int i = 0; i < m_objects; ++i) {
+        for (CaptureTool::Type type : types) {
+            tools << createTool(type, i);
+        }
+    }
+
+    // Everything but the last object is added directly, the last one goes
+    // through the undo stack like a committed tool does
+    CaptureToolObjects& objects = m_widget->m_captureToolObjects;
+    for (int i = 0; i < tools.size() - 1; ++i) {
+        objects.append(tools.at(i));
+    }
+    m_widget->m_captureToolObjectsBackup = objects;
+    objects.append(tools.last());
+    m_widget->pushObjectsStateToUndoStack();
+
+    for (CaptureTool* tool : tools) {
+        m_probes << tool->boundingRect().center();
+    }
+    // Misses walk the whole stack, so make sure some are measured too
+    for (int i = 0; i < m_objects; ++i) {
+        m_probes << randomPoint();
+    }
+}
+
+QJsonObject CaptureWidgetBenchmark::measure(
+  const QString& name,
+  const std::function<void()>& step,
+  const std::function<void()>& reset)
+{
+    return ::measure(name, m_iterations, step, reset);
+}
+
+QJsonArray CaptureWidgetBenchmark::measureInvert()
+{
+    QJsonArray results;
+    CaptureContext& context = m_widget->m_context;
+    for (int side : { 256, 1024, 4096 }) {
+        side = qMin(side, qMin(m_size.width(), m_size.height()));
+        CaptureTool* tool =
+          ToolFactory().CreateTool(CaptureTool::TYPE_INVERT, m_widget);
+        context.mousePos = QPoint(0, 0);
+        tool->drawStart(context);
+        tool->drawMove(QPoint(side, side));
+
+        QPixmap canvas = context.origScreenshot;
+        results << measure(QStringLiteral("invert/%1x%1").arg(side), [&]() {
+            m_widget->processPixmapWithTool(&canvas, tool);
+        });
+        delete tool;
+    }
+    return results;
+}
+
+QJsonObject CaptureWidgetBenchmark::run()
+{
+    CaptureWidget* w = m_widget;
+    QJsonArray results;
+
+    results << measure("drawToolsData/full", [w]() {
+        w->m_dirtyTiles.addAll();
+        w->drawToolsData();
+    });
+    // Dragging one object around only recomposites the tiles it covers
+    CaptureTool* moved = w->m_captureToolObjects.at(0);
+    const QPoint origin = *moved->pos();
+    int step = 0;
+    results << measure("drawToolsData/move", [w, moved, origin, &step]() {
+        moved->move(origin + QPoint(++step % 2 * 40, 0));
+        w->drawToolsData();
+    });
+    results << measure("paintEvent", [w]() { w->repaint(); });
+
+    int probe = 0;
+    results << measure("find", [this, w, &probe]() {
+        w->m_captureToolObjects.find(m_probes.at(probe++ % m_probes.size()),
+                                     w->size());
+    });
+
+    results << measure(
+      "undo", [w]() { w->undo(); }, [w]() { w->redo(); });
+    w->undo();
+    results << measure(
+      "redo", [w]() { w->redo(); }, [w]() { w->undo(); });
+    w->redo();
+
+    int last = w->m_captureToolObjects.size() - 1;
+    results << measure(
+      "reorder",
+      [w, last]() { w->onMoveCaptureToolUp(last); },
+      [w, last]() { w->onMoveCaptureToolDown(last - 1); });
+
+    for (const auto& result : measureInvert()) {
+        results << result;
+    }
+
+    return { { "benchmark", "capturewidget" },
+             { "platform", QGuiApplication::platformName() },
+             { "width", m_size.width() },
+             { "height", m_size.height() },
+             { "objects", m_widget->m_captureToolObjects.size() },
+             { "results", results } };
+}
+
+int main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    // Run against the default configuration instead of the user's one
+    QTemporaryDir configDir;
+    qputenv("XDG_CONFIG_HOME", configDir.path().toLocal8Bit());
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("flameshot"));
+    QCoreApplication::setOrganizationName(QStringLiteral("flameshot"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+      QStringLiteral("Headless capture editor benchmarks"));
+    parser.addHelpOption();
+    QCommandLineOption objectsOption(
+      "objects",
+      QStringLiteral("Number of objects of each tool type."),
+      "count",
+      "20");
+    QCommandLineOption iterationsOption(
+      "iterations", QStringLiteral("Timed runs per case."), "count", "20");
+    QCommandLineOption widthOption(
+      "width", QStringLiteral("Screenshot width."), "pixels", "7680");
+    QCommandLineOption heightOption(
+      "height", QStringLiteral("Screenshot height."), "pixels", "4320");
+    parser.addOptions(
+      { objectsOption, iterationsOption, widthOption, heightOption });
+    parser.process(app);
+
+    QSize size(parser.value(widthOption).toInt(),
+               parser.value(heightOption).toInt());
+    int objects = parser.value(objectsOption).toInt();
+    int iterations = parser.value(iterationsOption).toInt();
+    if (size.width() < 400 || size.height() < 200 || objects < 1 ||
+        iterations < 1) {
+        QTextStream(stderr) << "Invalid benchmark parameters\n";
+        return 1;
+    }
+
+    CaptureWidgetBenchmark benchmark(size, objects, iterations);
+    QTextStream(stdout) << QJsonDocument(benchmark.run()).toJson();
+    return 0;
+}
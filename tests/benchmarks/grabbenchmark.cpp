@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+// Latency of the X11 screen grab paths at 4K and 8K: QScreen::grabWindow
+// against the MIT-SHM grabber, both producing the QPixmap the capture widget
+// works on. Run it against an X server large enough for the biggest case, for
+// example Xvfb :99 -screen 0 7680x4320x24. The results are written to stdout
+// as JSON.
+
+#include "benchmarkstats.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPixmap>
+#include <QScreen>
+#include <QTextStream>
+
+#if defined(USE_XCB_SHM)
+#include "src/utils/xcbshmgrabber.h"
+#endif
+
+int main(int argc, char* argv[])
+{
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+      QStringLiteral("X11 screen grab benchmarks"));
+    parser.addHelpOption();
+    QCommandLineOption iterationsOption(
+      "iterations", QStringLiteral("Timed runs per case."), "count", "20");
+    parser.addOption(iterationsOption);
+    parser.process(app);
+
+    int iterations = parser.value(iterationsOption).toInt();
+    if (iterations < 1) {
+        QTextStream(stderr) << "Invalid benchmark parameters\n";
+        return 1;
+    }
+
+    QScreen* screen = QGuiApplication::primaryScreen();
+    const QSize available = screen->geometry().size();
+#if defined(USE_XCB_SHM)
+    XcbShmGrabber* shmGrabber = XcbShmGrabber::instance();
+#endif
+
+    QJsonArray results;
+    const QList<std::pair<QString, QSize>> cases = {
+        { QStringLiteral("4k"), QSize(3840, 2160) },
+        { QStringLiteral("8k"), QSize(7680, 4320) },
+    };
+    for (const auto& [label, requested] : cases) {
+        if (requested.width() > available.width() ||
+            requested.height() > available.height()) {
+            QTextStream(stderr)
+              << "Skipping " << label << ", the screen is only "
+              << available.width() << "x" << available.height() << "\n";
+            continue;
+        }
+        QRect rect(QPoint(0, 0), requested);
+
+        results << measure(
+          QStringLiteral("grabWindow/%1").arg(label), iterations, [&]() {
+              QPixmap p = screen->grabWindow(
+                0, rect.x(), rect.y(), rect.width(), rect.height());
+              Q_UNUSED(p)
+          });
+
+#if defined(USE_XCB_SHM)
+        if (!shmGrabber->isAvailable()) {
+            continue;
+        }
+        results << measure(
+          QStringLiteral("xcbShm/%1").arg(label), iterations, [&]() {
+              QImage image = shmGrabber->grab(rect);
+              Q_UNUSED(image)
+          });
+        results << measure(
+          QStringLiteral("xcbShmPixmap/%1").arg(label), iterations, [&]() {
+              QPixmap p = QPixmap::fromImage(shmGrabber->grab(rect));
+              Q_UNUSED(p)
+          });
+#endif
+    }
+
+    bool shmAvailable = false;
+#if defined(USE_XCB_SHM)
+    shmAvailable = shmGrabber->isAvailable();
+#endif
+    QJsonObject report = { { "benchmark", "grab" },
+                           { "platform", QGuiApplication::platformName() },
+                           { "xcbShm", shmAvailable },
+                           { "results", results } };
+    QTextStream(stdout) << QJsonDocument(report).toJson();
+    return 0;
+}
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+// App launcher search on a synthetic set of applications: each case times a
+// single keystroke, from the query before it, like typing or erasing in the
+// search field. A few known applications are checked to come first for their
+// query, or to match at all, before anything is timed. It needs no display.
+// The results are written to stdout as JSON.
+
+#include "benchmarkstats.h"
+#include "src/tools/launcher/launchersearchmodel.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <iterator>
+
+namespace {
+
+const char* const SYLLABLES[] = { "ka", "lo", "mi",  "ne", "ra",  "sto",
+                                  "vi", "ze", "pho", "tri", "gen", "dex" };
+
+QString word(QRandomGenerator& random)
+{
+    QString result;
+    const int syllables = 2 + random.bounded(3);
+    for (int i = 0; i < syllables; ++i) {
+        result += QLatin1String(
+          SYLLABLES[random.bounded(int(std::size(SYLLABLES)))]);
+    }
+    return result;
+}
+
+QVector<DesktopAppData> syntheticApps(int count)
+{
+    QRandomGenerator random(42);
+    QVector<DesktopAppData> apps;
+    apps.append(DesktopAppData(QStringLiteral("GIMP"),
+                               QStringLiteral("Create images and edit photos"),
+                               QStringLiteral("gimp-2.10 %U"),
+                               QIcon()));
+    apps.append(DesktopAppData(QStringLiteral("Krita"),
+                               QStringLiteral("Digital Painting"),
+                               QStringLiteral("krita %F"),
+                               QIcon()));
+    while (apps.size() < count) {
+        QString name = word(random);
+        name[0] = name[0].toUpper();
+        QString description = word(random) + ' ' + word(random) + ' ' +
+                              word(random) + QStringLiteral(" écran");
+        apps.append(DesktopAppData(
+          name, description, "/usr/bin/" + word(random) + " %f", QIcon()));
+    }
+    return apps;
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+      QStringLiteral("App launcher search benchmarks"));
+    parser.addHelpOption();
+    QCommandLineOption iterationsOption(
+      "iterations", QStringLiteral("Timed runs per case."), "count", "100");
+    QCommandLineOption appsOption(
+      "apps", QStringLiteral("Applications searched."), "count", "6000");
+    parser.addOption(iterationsOption);
+    parser.addOption(appsOption);
+    parser.process(app);
+
+    int iterations = parser.value(iterationsOption).toInt();
+    int appCount = parser.value(appsOption).toInt();
+    if (iterations < 1 || appCount < 2) {
+        QTextStream(stderr) << "Invalid benchmark parameters\n";
+        return 1;
+    }
+
+    LauncherSearchModel model;
+    model.setApps(syntheticApps(appCount));
+    const QList<QPair<QString, QString>> expected = {
+        { QStringLiteral("gimp"), QStringLiteral("GIMP") },
+        { QStringLiteral("KRI"), QStringLiteral("Krita") },
+        { QStringLiteral("digital p"), QStringLiteral("Krita") },
+    };
+    for (const auto& query : expected) {
+        model.setQuery(query.first);
+        QString first = model.data(model.index(0)).toString();
+        if (first != query.second) {
+            QTextStream(stderr) << query.first << ": the first match is '"
+                                << first << "' instead of '" << query.second
+                                << "'\n";
+            return 1;
+        }
+    }
+
+    // Subsequences that taking the characters at word starts alone misses
+    LauncherSearchModel subsequences;
+    subsequences.setApps({ DesktopAppData(
+      QStringLiteral("GNU Image Manipulation Program"),
+      QStringLiteral("Image Editor"),
+      QStringLiteral("gimp %U"),
+      QIcon()) });
+    for (const QString& query : { QStringLiteral("pi"),
+                                  QStringLiteral("gnu manip") }) {
+        subsequences.setQuery(query);
+        if (subsequences.rowCount() != 1) {
+            QTextStream(stderr)
+              << query << ": 'GNU Image Manipulation Program' doesn't match\n";
+            return 1;
+        }
+    }
+
+    // From the query before the keystroke to the one after it
+    const QList<QPair<QString, QString>> keystrokes = {
+        { QString(), QStringLiteral("k") },
+        { QStringLiteral("k"), QStringLiteral("ka") },
+        { QStringLiteral("ka"), QStringLiteral("kal") },
+        { QStringLiteral("kalo"), QStringLiteral("kalom") },
+        { QStringLiteral("kal"), QStringLiteral("ka") },
+        { QStringLiteral("ka"), QStringLiteral("k") },
+        { QStringLiteral("ecra"), QStringLiteral("ecran") },
+    };
+
+    QJsonArray results;
+    for (const auto& keystroke : keystrokes) {
+        model.setQuery(keystroke.first);
+        results << measure(
+          QStringLiteral("'%1' to '%2'/%3")
+            .arg(keystroke.first, keystroke.second)
+            .arg(appCount),
+          iterations,
+          [&]() { model.setQuery(keystroke.second); },
+          [&]() { model.setQuery(keystroke.first); });
+    }
+
+    QJsonObject report = { { "benchmark", "launcher-search" },
+                           { "results", results } };
+    QTextStream(stdout) << QJsonDocument(report).toJson();
+    return 0;
+}
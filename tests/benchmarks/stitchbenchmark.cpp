@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+// Scrolling capture stitching on synthetic pages: a tall page of noisy text
+// lines separated by blank ones is cut into viewport sized frames, between a
+// fixed toolbar and status bar, at irregular scroll offsets. Every sequence is
+// checked against the page it was cut from before it is timed, so a wrong
+// registration fails the run. It needs no display. The results are written to
+// stdout as JSON.
+
+#include "benchmarkstats.h"
+#include "src/utils/scrollstitcher.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <cstring>
+
+namespace {
+
+struct Sequence
+{
+    QString name;
+    QVector<QImage> frames;
+    QImage expected;
+};
+
+QImage syntheticPage(int width, int height, QRandomGenerator& random)
+{
+    QImage page(width, height, QImage::Format_RGB32);
+    page.fill(Qt::white);
+    int y = 0;
+    while (y < height) {
+        y += 4 + random.bounded(12);
+        int lineEnd = qMin(height, y + 10 + random.bounded(10));
+        int textWidth = width / 4 + random.bounded(width * 3 / 4);
+        for (; y < lineEnd; ++y) {
+            auto* line = reinterpret_cast<QRgb*>(page.scanLine(y));
+            for (int x = 16; x < textWidth - 16; ++x) {
+                quint32 shade = random.bounded(256);
+                line[x] = qRgb(shade, shade, shade);
+            }
+        }
+    }
+    return page;
+}
+
+QImage bar(int width, int height, QRgb color)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(color);
+    return image;
+}
+
+// `header` + page rows [top, top + visible) + `footer`
+QImage viewport(const QImage& page,
+                const QImage& header,
+                const QImage& footer,
+                int top,
+                int visible)
+{
+    QImage frame(page.width(),
+                 header.height() + visible + footer.height(),
+                 QImage::Format_RGB32);
+    const size_t length = static_cast<size_t>(page.bytesPerLine());
+    int y = 0;
+    for (int i = 0; i < header.height(); ++i) {
+        std::memcpy(frame.scanLine(y++), header.constScanLine(i), length);
+    }
+    for (int i = 0; i < visible; ++i) {
+        std::memcpy(frame.scanLine(y++), page.constScanLine(top + i), length);
+    }
+    for (int i = 0; i < footer.height(); ++i) {
+        std::memcpy(frame.scanLine(y++), footer.constScanLine(i), length);
+    }
+    return frame;
+}
+
+Sequence scrollSequence(const QString& name,
+                        const QSize& viewportSize,
+                        int pageHeight,
+                        const QVector<int>& offsets)
+{
+    QRandomGenerator random(42);
+    const int width = viewportSize.width();
+    QImage page = syntheticPage(width, pageHeight, random);
+    QImage header = bar(width, 64, qRgb(40, 40, 60));
+    QImage footer = bar(width, 24, qRgb(220, 220, 230));
+    const int visible = viewportSize.height() - 64 - 24;
+
+    Sequence sequence{ name, {}, {} };
+    int top = 0;
+    sequence.frames << viewport(page, header, footer, top, visible);
+    for (int offset : offsets) {
+        top = qMin(top + offset, pageHeight - visible);
+        sequence.frames << viewport(page, header, footer, top, visible);
+    }
+    sequence.expected = viewport(page, header, footer, 0, top + visible);
+    return sequence;
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+      QStringLiteral("Scrolling capture stitching benchmarks"));
+    parser.addHelpOption();
+    QCommandLineOption iterationsOption(
+      "iterations", QStringLiteral("Timed runs per case."), "count", "10");
+    parser.addOption(iterationsOption);
+    parser.process(app);
+
+    int iterations = parser.value(iterationsOption).toInt();
+    if (iterations < 1) {
+        QTextStream(stderr) << "Invalid benchmark parameters\n";
+        return 1;
+    }
+
+    // Small steps like a mouse wheel, then large jumps like page down, with
+    // frames that did not move in between
+    const QVector<int> wheel = { 40, 40, 0, 80, 40, 120, 0, 40, 40, 80 };
+    const QVector<int> pages = { 600, 0, 450, 700, 20, 650, 0, 500 };
+    const QList<Sequence> sequences = {
+        scrollSequence(
+          QStringLiteral("wheel/1080p"), QSize(1920, 1080), 2400, wheel),
+        scrollSequence(
+          QStringLiteral("pages/1080p"), QSize(1920, 1080), 6000, pages),
+        scrollSequence(
+          QStringLiteral("wheel/4k"), QSize(3840, 2160), 4000, wheel),
+    };
+
+    QJsonArray results;
+    for (const Sequence& sequence : sequences) {
+        ScrollStitcher stitcher;
+        for (const QImage& frame : sequence.frames) {
+            stitcher.addFrame(frame);
+        }
+        if (stitcher.result() != sequence.expected) {
+            QTextStream(stderr)
+              << sequence.name << ": the stitched image is "
+              << stitcher.height() << " rows high instead of "
+              << sequence.expected.height() << " or differs from the page\n";
+            return 1;
+        }
+
+        stitcher.clear();
+        results << measure(
+          sequence.name,
+          iterations,
+          [&]() {
+              for (const QImage& frame : sequence.frames) {
+                  stitcher.addFrame(frame);
+              }
+              QImage image = stitcher.result();
+              Q_UNUSED(image)
+          },
+          [&]() { stitcher.clear(); });
+    }
+
+    QJsonObject report = { { "benchmark", "stitch" }, { "results", results } };
+    QTextStream(stdout) << QJsonDocument(report).toJson();
+    return 0;
+}
@@ -0,0 +1,168 @@
+#!/usr/bin/env sh
+
+# Tests the HTTP upload storage and the upload queue against
+# mock_upload_server.py, capturing through mock_portal.py on a private session
+# bus, without a display
+# Arguments:
+# 1. path to tested flameshot executable, built with ENABLE_IMGUR
+
+# Dependencies:
+# - dbus-run-session (dbus)
+# - python3 with dbus-python and PyGObject
+
+# HOW TO USE:
+# - Start the script with path to tested flameshot executable as the first
+#   argument. It prints the result of every check and exits with the number of
+#   failed ones.
+
+FLAMESHOT="$1"
+[ -z "$FLAMESHOT" ] && FLAMESHOT="flameshot"
+FLAMESHOT="$(command -v "$FLAMESHOT")"
+TESTS_DIR="$(cd "$(dirname "$0")" && pwd)"
+PORT=8765
+
+if [ -z "$UPLOAD_TEST_SESSION" ]; then
+    export UPLOAD_TEST_SESSION=1
+    exec dbus-run-session -- sh "$0" "$FLAMESHOT"
+fi
+
+export QT_QPA_PLATFORM=offscreen
+export XDG_SESSION_TYPE=wayland
+export XDG_CURRENT_DESKTOP=GNOME
+export XDG_CONFIG_HOME="$(mktemp -d)"
+export XDG_CACHE_HOME="$(mktemp -d)"
+OUT_DIR="$(mktemp -d)"
+failed=0
+
+mkdir -p "$XDG_CONFIG_HOME/flameshot"
+cat >"$XDG_CONFIG_HOME/flameshot/flameshot.ini" <<EOF
+[General]
+uploadWithoutConfirmation=true
+copyURLAfterUpload=false
+uploadStorage=http
+uploadHttpUrl=http://127.0.0.1:$PORT/upload
+uploadHttpField=screenshot
+uploadHttpAuthorization=Bearer test
+uploadHttpLink=http://127.0.0.1:$PORT/i/{name}
+uploadHttpDeleteUrl=http://127.0.0.1:$PORT/i/{name}?token={token}
+EOF
+
+python3 "$TESTS_DIR/mock_portal.py" 800 600 0 &
+PORTAL_PID=$!
+SERVER_PID=
+trap 'kill $PORTAL_PID $SERVER_PID' EXIT
+sleep 1
+
+# Start the image store, writing to the directory $1, failing the first $2
+# uploads
+start_server() {
+    mkdir -p "$1"
+    python3 "$TESTS_DIR/mock_upload_server.py" $PORT "$1" screenshot \
+      "Bearer test" "${2:-0}" 2>/dev/null &
+    SERVER_PID=$!
+    sleep 1
+}
+
+stop_server() {
+    kill $SERVER_PID
+    SERVER_PID=
+}
+
+# Print the PNG size as WIDTHxHEIGHT
+png_size() {
+    python3 -c 'import struct, sys
+data = open(sys.argv[1], "rb").read(24)
+print("%dx%d" % struct.unpack(">II", data[16:24]))' "$1"
+}
+
+check() {
+    if [ "$2" = "$3" ]; then
+        echo "PASS: $1"
+    else
+        echo "FAIL: $1, expected '$3' but got '$2'"
+        failed=$((failed + 1))
+    fi
+}
+
+# Wait up to $2 s, 10 by default, for the file $1
+wait_for() {
+    for _ in $(seq $((${2:-10} * 5))); do
+        [ -e "$1" ] && return 0
+        sleep 0.2
+    done
+    return 1
+}
+
+UPLOADS_DIR="$XDG_CACHE_HOME/flameshot/uploads"
+HISTORY_DIR="$XDG_CACHE_HOME/flameshot/history"
+
+echo ">> full --upload: the capture is posted to the server"
+start_server "$OUT_DIR/plain"
+# The upload window stays open once the upload is done
+"$FLAMESHOT" full --upload &
+FLAMESHOT_PID=$!
+wait_for "$OUT_DIR/plain/img1.png"
+check "the server received the capture" "$?" "0"
+check "the capture has the desktop size" \
+  "$(png_size "$OUT_DIR/plain/img1.png" 2>/dev/null)" "800x600"
+wait_for "$HISTORY_DIR/http-tok%2D1-img1.png"
+check "the upload was added to the history" "$?" "0"
+check "the job was removed" "$(ls "$UPLOADS_DIR" | wc -l)" "0"
+kill $FLAMESHOT_PID
+stop_server
+
+echo ">> full --upload: the same capture again is not sent"
+start_server "$OUT_DIR/plain"
+"$FLAMESHOT" full --upload &
+FLAMESHOT_PID=$!
+sleep 3
+check "the server received nothing" "$(ls "$OUT_DIR/plain" | wc -l)" "1"
+check "the job was removed" "$(ls "$UPLOADS_DIR" | wc -l)" "0"
+kill $FLAMESHOT_PID
+stop_server
+# The next captures are sent again
+rm -rf "$HISTORY_DIR"
+
+echo ">> full --upload: the server fails twice, the upload is retried"
+start_server "$OUT_DIR/retried" 2
+"$FLAMESHOT" full --upload &
+FLAMESHOT_PID=$!
+# Retried after about 1 and 2 s
+wait_for "$OUT_DIR/retried/img1.png" 15
+check "the third attempt went through" "$?" "0"
+kill $FLAMESHOT_PID
+stop_server
+
+echo ">> full --upload: the process exits while the server is down"
+"$FLAMESHOT" full --upload &
+FLAMESHOT_PID=$!
+wait_for "$(echo "$UPLOADS_DIR"/*.json)"
+sleep 1
+kill $FLAMESHOT_PID
+check "the job is left on disk" "$(ls "$UPLOADS_DIR"/*.img | wc -l)" "1"
+
+echo ">> the daemon resumes the job once it starts"
+start_server "$OUT_DIR/resumed"
+"$FLAMESHOT" &
+DAEMON_PID=$!
+wait_for "$OUT_DIR/resumed/img1.png"
+check "the resumed job was uploaded" "$?" "0"
+sleep 1
+check "the resumed job was removed" "$(ls "$UPLOADS_DIR" | wc -l)" "0"
+kill $DAEMON_PID
+stop_server
+
+echo ">> full --upload: the capture has more pixels than allowed"
+rm -rf "$HISTORY_DIR"
+echo "uploadMaxPixels=120000" >>"$XDG_CONFIG_HOME/flameshot/flameshot.ini"
+start_server "$OUT_DIR/downscaled"
+"$FLAMESHOT" full --upload &
+FLAMESHOT_PID=$!
+wait_for "$OUT_DIR/downscaled/img1.png"
+check "the capture was downscaled" \
+  "$(png_size "$OUT_DIR/downscaled/img1.png" 2>/dev/null)" "400x300"
+kill $FLAMESHOT_PID
+stop_server
+
+rm -rf "$OUT_DIR" "$XDG_CONFIG_HOME" "$XDG_CACHE_HOME"
+exit $failed
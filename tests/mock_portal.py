@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+
+# Minimal org.freedesktop.portal.Screenshot service used by portal_capture.sh.
+# Every Screenshot call writes a WIDTHxHEIGHT gradient as a PPM file and
+# answers through the Request object after DELAY milliseconds, the way the
+# real portal does once its dialog or permission check is done.
+#
+# Dependencies:
+# - dbus-python and PyGObject
+#
+# Usage: mock_portal.py [WIDTH HEIGHT [DELAY]]
+
+import os
+import sys
+import tempfile
+
+import dbus
+import dbus.service
+from dbus.mainloop.glib import DBusGMainLoop
+from gi.repository import GLib
+
+PORTAL_NAME = "org.freedesktop.portal.Desktop"
+PORTAL_PATH = "/org/freedesktop/portal/desktop"
+
+width = int(sys.argv[1]) if len(sys.argv) > 1 else 800
+height = int(sys.argv[2]) if len(sys.argv) > 2 else 600
+delay = int(sys.argv[3]) if len(sys.argv) > 3 else 1000
+
+
+def write_image():
+    fd, path = tempfile.mkstemp(prefix="mock-portal-", suffix=".ppm")
+    with os.fdopen(fd, "wb") as f:
+        f.write(b"P6 %d %d 255\n" % (width, height))
+        row = bytearray()
+        for x in range(width):
+            row += bytes((x * 255 // width, 0, 0))
+        for y in range(height):
+            blue = y * 255 // height
+            row[2::3] = bytes((blue,)) * width
+            f.write(row)
+    return path
+
+
+class Request(dbus.service.Object):
+    @dbus.service.signal("org.freedesktop.portal.Request", signature="ua{sv}")
+    def Response(self, response, results):
+        pass
+
+    def respond(self):
+        path = write_image()
+        print("mock portal: answering with " + path, file=sys.stderr)
+        self.Response(dbus.UInt32(0), {"uri": "file://" + path})
+        self.remove_from_connection()
+        return False
+
+
+class Portal(dbus.service.Object):
+    @dbus.service.method("org.freedesktop.portal.Screenshot",
+                         in_signature="sa{sv}",
+                         out_signature="o",
+                         sender_keyword="sender")
+    def Screenshot(self, parent_window, options, sender):
+        token = str(options.get("handle_token", "flameshot"))
+        path = "%s/request/%s/%s" % (PORTAL_PATH,
+                                     sender[1:].replace(".", "_"),
+                                     token)
+        request = Request(self.connection, path)
+        GLib.timeout_add(delay, request.respond)
+        return dbus.ObjectPath(path)
+
+
+DBusGMainLoop(set_as_default=True)
+bus = dbus.SessionBus()
+name = dbus.service.BusName(PORTAL_NAME, bus)
+portal = Portal(bus, PORTAL_PATH)
+print("mock portal: ready", file=sys.stderr)
+GLib.MainLoop().run()
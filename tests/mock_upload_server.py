@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+
+# Minimal image store used by http_upload.sh. A multipart/form-data POST saves
+# the file of the IMAGE field to OUT_DIR as imgN.png and answers with its name
+# and a delete token, a DELETE appends its path to OUT_DIR/deleted. Requests
+# without the expected Authorization header, when one is given, are refused.
+# The first FAILURES uploads are answered with 503, like an overloaded server.
+#
+# Usage: mock_upload_server.py PORT OUT_DIR [FIELD [AUTHORIZATION [FAILURES]]]
+
+import email.parser
+import email.policy
+import json
+import os
+import sys
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+port = int(sys.argv[1])
+out_dir = sys.argv[2]
+field = sys.argv[3] if len(sys.argv) > 3 else "image"
+authorization = sys.argv[4] if len(sys.argv) > 4 and sys.argv[4] else None
+failures = int(sys.argv[5]) if len(sys.argv) > 5 else 0
+uploads = 0
+
+
+class Handler(BaseHTTPRequestHandler):
+    def authorized(self):
+        if authorization and self.headers.get("Authorization") != authorization:
+            self.send_error(401)
+            return False
+        return True
+
+    def read_body(self):
+        if self.headers.get("Transfer-Encoding", "").lower() == "chunked":
+            body = b""
+            while True:
+                size = int(self.rfile.readline().split(b";")[0], 16)
+                if size == 0:
+                    self.rfile.readline()
+                    return body
+                body += self.rfile.read(size)
+                self.rfile.readline()
+        return self.rfile.read(int(self.headers.get("Content-Length", 0)))
+
+    def do_POST(self):
+        global uploads, failures
+        body = self.read_body()
+        if not self.authorized():
+            return
+        if failures > 0:
+            failures -= 1
+            self.send_error(503)
+            return
+        header = b"Content-Type: " + self.headers["Content-Type"].encode()
+        message = email.parser.BytesParser(
+            policy=email.policy.HTTP).parsebytes(header + b"\r\n\r\n" + body)
+        for part in message.iter_parts():
+            if part.get_param("name", header="content-disposition") != field:
+                continue
+            uploads += 1
+            name = "img%d.png" % uploads
+            with open(os.path.join(out_dir, name), "wb") as f:
+                f.write(part.get_payload(decode=True))
+            answer = json.dumps({"name": name, "token": "tok-%d" % uploads})
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.end_headers()
+            self.wfile.write(answer.encode())
+            return
+        self.send_error(400, "no %s field" % field)
+
+    def do_DELETE(self):
+        if not self.authorized():
+            return
+        with open(os.path.join(out_dir, "deleted"), "a") as f:
+            f.write(self.path + "\n")
+        self.send_response(204)
+        self.end_headers()
+
+
+ThreadingHTTPServer(("127.0.0.1", port), Handler).serve_forever()
@@ -0,0 +1,82 @@
+#!/usr/bin/env sh
+
+# Tests the xdg-desktop-portal capture path against mock_portal.py on a private
+# session bus, without a wayland compositor or a display
+# Arguments:
+# 1. path to tested flameshot executable
+
+# Dependencies:
+# - dbus-run-session (dbus)
+# - python3 with dbus-python and PyGObject
+
+# HOW TO USE:
+# - Start the script with path to tested flameshot executable as the first
+#   argument. It prints the result of every check and exits with the number of
+#   failed ones.
+
+FLAMESHOT="$1"
+[ -z "$FLAMESHOT" ] && FLAMESHOT="flameshot"
+FLAMESHOT="$(command -v "$FLAMESHOT")"
+TESTS_DIR="$(cd "$(dirname "$0")" && pwd)"
+
+if [ -z "$PORTAL_TEST_SESSION" ]; then
+    export PORTAL_TEST_SESSION=1
+    exec dbus-run-session -- sh "$0" "$FLAMESHOT"
+fi
+
+# The offscreen platform has a single 800x600 screen
+export QT_QPA_PLATFORM=offscreen
+export XDG_SESSION_TYPE=wayland
+export XDG_CURRENT_DESKTOP=GNOME
+export XDG_CONFIG_HOME="$(mktemp -d)"
+OUT_DIR="$(mktemp -d)"
+failed=0
+
+python3 "$TESTS_DIR/mock_portal.py" 800 600 1000 &
+PORTAL_PID=$!
+trap 'kill $PORTAL_PID' EXIT
+sleep 1
+
+# Print the PNG size as WIDTHxHEIGHT
+png_size() {
+    python3 -c 'import struct, sys
+data = open(sys.argv[1], "rb").read(24)
+print("%dx%d" % struct.unpack(">II", data[16:24]))' "$1"
+}
+
+check() {
+    if [ "$2" = "$3" ]; then
+        echo "PASS: $1"
+    else
+        echo "FAIL: $1, expected '$3' but got '$2'"
+        failed=$((failed + 1))
+    fi
+}
+
+echo ">> full: the portal answers after a second"
+"$FLAMESHOT" full -p "$OUT_DIR/full.png"
+check "full exits successfully" "$?" "0"
+check "full has the desktop size" "$(png_size "$OUT_DIR/full.png")" "800x600"
+
+echo ">> full --region: the selection is cut from the portal image"
+"$FLAMESHOT" full --region 200x100+10+20 -p "$OUT_DIR/region.png"
+check "full --region exits successfully" "$?" "0"
+check "full --region has the region size" \
+  "$(png_size "$OUT_DIR/region.png")" "200x100"
+
+echo ">> screen: the screen is cut from the portal image"
+"$FLAMESHOT" screen -p "$OUT_DIR/screen.png"
+check "screen exits successfully" "$?" "0"
+check "screen has the screen size" "$(png_size "$OUT_DIR/screen.png")" "800x600"
+
+check "the portal files were removed" \
+  "$(find "${TMPDIR:-/tmp}" -maxdepth 1 -name 'mock-portal-*' | wc -l)" "0"
+
+echo ">> full without a portal fails instead of waiting forever"
+kill $PORTAL_PID
+trap - EXIT
+"$FLAMESHOT" full -p "$OUT_DIR/none.png"
+check "full fails" "$?" "1"
+
+rm -rf "$OUT_DIR" "$XDG_CONFIG_HOME"
+exit $failed